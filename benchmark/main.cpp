@@ -0,0 +1,566 @@
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+#include <Eigen/Sparse>
+#include <muParser.h>
+#include <sequencer/sequencer.h>
+
+using namespace std;
+using namespace sequencer_n;
+
+namespace reference_n
+{
+    sequence_t terms;
+
+    double s(const double index)
+    {
+        const size_t _index = static_cast<size_t>(round(index));
+        return _index < terms.size() ? terms[_index] : DBL_MAX;
+    }
+
+    // mirrors the former generic rule loop of generate() that handed the rule to the parser for every term
+    sequence_t generateReparsingPerTerm(const vector<string> &rules, const double firstTerm, const size_t length)
+    {
+        double n = 0;
+        mu::Parser parser;
+        parser.DefineVar("n", &n);
+        parser.DefineFun("s", s);
+
+        terms.clear();
+        terms.push_back(firstTerm);
+
+        for(size_t index = 1; index < length; index++)
+        {
+            n = static_cast<double>(index);
+            string rule = rules[index % rules.size()];
+            parser.SetExpr(rule);
+            terms.push_back(parser.Eval());
+        }
+
+        return terms;
+    }
+
+    // mirrors the former explicit rule loop of generate() that evaluated the rule once per index
+    sequence_t generateExplicitScalar(const string &rule, const size_t length)
+    {
+        double n = 0;
+        mu::Parser parser;
+        parser.DefineVar("n", &n);
+        parser.SetExpr(rule);
+
+        sequence_t sequence;
+        for(size_t index = 0; index < length; index++)
+        {
+            n = static_cast<double>(index);
+            sequence.push_back(parser.Eval());
+        }
+
+        return sequence;
+    }
+
+    // mirrors the former linear recurrence stage of solve() that ran a sparse iterative solve per order
+    size_t solveLinearRecurrencePerOrder(const sequence_t &sequence)
+    {
+        using namespace Eigen;
+
+        size_t solvedOrders = 0;
+
+        for(int order = static_cast<int>(sequence.size()) >> 1; order > 0; order--)
+        {
+            SparseMatrix<double> matrix(order, order);
+            VectorXd constants(order);
+            vector<Triplet<double>> tripletList;
+            tripletList.reserve(order * order);
+
+            for(int i = 0; i < order; i++)
+            {
+                for(int j = 0, k = i; j < order; j++, k++)
+                    tripletList.push_back(Triplet<double>(i, j, sequence[k]));
+                constants[i] = sequence[i + order];
+            }
+
+            matrix.setFromTriplets(tripletList.begin(), tripletList.end());
+            BiCGSTAB<SparseMatrix<double>> solver;
+            solver.compute(matrix);
+            if(solver.info() != Success)
+                continue;
+
+            VectorXd coefficients = solver.solve(constants);
+            if(solver.info() == Success)
+                solvedOrders++;
+        }
+
+        return solvedOrders;
+    }
+
+    // mirrors the former continuation of a linear recurrence that looked every term up through a function
+    sequence_t continueRecurrenceTermwise(const sequence_t &sequence, const vector<double> &coefficients, const size_t count)
+    {
+        sequence_t predictions;
+        const function<double(size_t)> term = [&sequence, &predictions](const size_t index) {
+            return index < sequence.size() ? sequence[index] : predictions[index - sequence.size()];
+        };
+
+        for(size_t newIndex = sequence.size(); predictions.size() < count; newIndex++)
+        {
+            double number = 0.0;
+            for(size_t i = 0; i < coefficients.size(); i++)
+                number += coefficients[i] * term(newIndex - coefficients.size() + i);
+            predictions.push_back(number);
+        }
+
+        return predictions;
+    }
+}
+
+double measure(const function<void()> &function)
+{
+    const auto start = chrono::steady_clock::now();
+    function();
+    const auto end = chrono::steady_clock::now();
+    return chrono::duration<double>(end - start).count();
+}
+
+void report(const string &name, const size_t count, const double seconds, const string &unit = "terms")
+{
+    fmt::print("  {:<52} {:>11} {} in {:8.3f} s  ({:10.3e} {}/s)\n", name, count, unit, seconds, count / seconds, unit);
+}
+
+void benchmarkGenerator(const vector<size_t> &lengths)
+{
+    const vector<string> rules { "s(0) = 1", "s(4n+3) = s(n-1) + 4", "s(4n) = s(n-1) + 2" };
+    const vector<string> referenceRules { "s(n-1) + 2", "s(n-1) + 2", "s(n-1) + 2", "s(n-1) + 4" };
+
+    fmt::print("Generator: conditional recurrence s(4n+3) = s(n-1) + 4, s(4n) = s(n-1) + 2\n");
+
+    for(const auto length : lengths)
+    {
+        report("reparsing the rule per term", length, measure([&]() {
+            reference_n::generateReparsingPerTerm(referenceRules, 1, length);
+        }));
+
+        report("generate() with compiled rules", length, measure([&]() {
+            generate(rules, { length });
+        }));
+
+        report("generate() with rules compiled into closures", length, measure([&]() {
+            generate(rules, { length, 0, 1, expressionBackend_t::COMPILED });
+        }));
+    }
+}
+
+void benchmarkExplicitGenerator(const vector<size_t> &lengths)
+{
+    const string rule = "3*n + 2";
+
+    fmt::print("Generator: explicit rule s(n) = {}\n", rule);
+
+    for(const auto length : lengths)
+    {
+        report("scalar evaluation per index", length, measure([&]() {
+            reference_n::generateExplicitScalar(rule, length);
+        }));
+
+        report("generate() with bulk evaluation", length, measure([&]() {
+            generate(rule, { length });
+        }));
+
+        report("generate() with the rule compiled into closures", length, measure([&]() {
+            generate(rule, { length, 0, 1, expressionBackend_t::COMPILED });
+        }));
+
+        for(size_t workerCount = 2; workerCount <= thread::hardware_concurrency(); workerCount <<= 1)
+        {
+            report(fmt::format("generate() with bulk evaluation on {} workers", workerCount), length, measure([&]() {
+                generate(rule, { length, 0, workerCount });
+            }));
+        }
+    }
+}
+
+void benchmarkShortGeneration(const size_t callCount)
+{
+    const vector<string> rules { "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" };
+
+    fmt::print("Generator: short Fibonacci sequences of 8 terms\n");
+
+    setRuleCacheCapacity(0);
+    report("generate() calls without rule cache", callCount, measure([&]() {
+        for(size_t i = 0; i < callCount; i++)
+            generate(rules, { 8 });
+    }), "calls");
+
+    setRuleCacheCapacity(64);
+    report("generate() calls with rule cache", callCount, measure([&]() {
+        for(size_t i = 0; i < callCount; i++)
+            generate(rules, { 8 });
+    }), "calls");
+}
+
+void benchmarkSolver(const vector<size_t> &lengths)
+{
+    // a recurrence of order 4 and a sequence without any short recurrence
+    for(const string rule : { "sin(0.3*n) + 0.5*cos(0.7*n)", "sin(n^2)" })
+    {
+        fmt::print("Solver: sequence given by s(n) = {}\n", rule);
+
+        for(const auto length : lengths)
+        {
+            const auto sequence = generate(rule, { length });
+            const size_t repetitions = std::max<size_t>(1, 20000 / length);
+
+            // the former path grows with the fourth power of the length and is only measured on short sequences
+            if(length <= 200)
+            {
+                const size_t referenceRepetitions = std::max<size_t>(1, 400 / length);
+                report(fmt::format("sparse solve per order on {} terms", length), referenceRepetitions, measure([&]() {
+                    for(size_t i = 0; i < referenceRepetitions; i++)
+                        reference_n::solveLinearRecurrencePerOrder(sequence);
+                }), "calls");
+            }
+
+            for(const int maximumOrder : { 5, 1000 })
+            {
+                report(fmt::format("solve() on {} terms up to order {}", length, maximumOrder), repetitions, measure([&]() {
+                    for(size_t i = 0; i < repetitions; i++)
+                        solve(sequence, { 1, false, maximumOrder });
+                }), "calls");
+            }
+
+            for(const bool parallelDetectors : { false, true })
+            {
+                solverContext_t context { 1, true, 1000 };
+                context.parallelDetectors = parallelDetectors;
+
+                report(fmt::format("solve() on {} terms, all detectors{}", length, parallelDetectors ? " in parallel" : ""),
+                    repetitions, measure([&]() {
+                        for(size_t i = 0; i < repetitions; i++)
+                            solve(sequence, context);
+                    }), "calls");
+            }
+        }
+    }
+}
+
+// long enough that the polynomial and the periodic pattern detector take about the same time, which is where running
+// the detectors side by side pays off on more than one core
+void benchmarkParallelDetectors(const size_t length)
+{
+    const auto sequence = generate("sin(n^2)", { length });
+
+    fmt::print("Solver: all detectors on {} terms, polynomials up to degree 20\n", length);
+
+    for(const bool parallelDetectors : { false, true })
+    {
+        solverContext_t context { 1, true };
+        context.maximumPolynomialDegree = 20;
+        context.parallelDetectors = parallelDetectors;
+
+        report(fmt::format("solve(){}", parallelDetectors ? " with detectors in parallel" : ""), 10, measure([&]() {
+            for(size_t i = 0; i < 10; i++)
+                solve(sequence, context);
+        }), "calls");
+    }
+}
+
+void benchmarkArtefacts(const size_t length)
+{
+    fmt::print("Solver: differences and ratios of {} terms\n", length);
+
+    // only the detectors that read nothing but the artefacts and their flags
+    solverContext_t context { 1, true };
+    context.enabledDetectors = detector_t::ARITHMETIC | detector_t::GEOMETRIC;
+
+    for(const string rule : { "3*n + 2", "0.1*n + mod(n, 3)" })
+    {
+        const auto sequence = generate(rule, { length });
+        report(fmt::format("solve() on s(n) = {}", rule), length, measure([&]() {
+            solve(sequence, context);
+        }));
+    }
+}
+
+void benchmarkPeriodicSolver(const size_t length)
+{
+    // the differences repeat every seventh term up to rounding
+    const auto sequence = generate("mod(n, 7) + 0.1*n", { length });
+
+    fmt::print("Solver: periodic pattern over {} terms\n", length);
+
+    report("solve() with periodic patterns only", 1, measure([&]() {
+        solverContext_t context { 1 };
+        context.enabledDetectors = detector_t::PERIODIC_PATTERN;
+        solve(sequence, context);
+    }), "calls");
+}
+
+void benchmarkPolynomialSolver(const size_t length)
+{
+    const auto sequence = generate("n^3 - 2*n^2 + 5", { length });
+
+    fmt::print("Solver: cubic polynomial over {} terms\n", length);
+
+    const auto run = [&sequence](const detector_t detectors) {
+        return measure([&]() {
+            solverContext_t context { 16 };
+            context.enabledDetectors = detectors;
+            solve(sequence, context);
+        });
+    };
+
+    report("solve() with the polynomial detector", 1, run(detector_t::POLYNOMIAL), "calls");
+    report("solve() with the linear recurrence detector", 1, run(detector_t::LINEAR_RECURRENCE), "calls");
+}
+
+void benchmarkLongContinuation(const size_t count)
+{
+    fmt::print("Solver: continuation by {} terms\n", count);
+
+    const string recurrence = "sin(0.3*n) + 0.5*cos(0.7*n)";
+    const auto sequence = generate(recurrence, { 40 });
+    const vector<double> coefficients { -1.0, 2.0 * (cos(0.3) + cos(0.7)), -2.0 - 4.0 * cos(0.3) * cos(0.7), 2.0 * (cos(0.3) + cos(0.7)) };
+
+    report("function lookup per term, recurrence of order 4", count, measure([&]() {
+        reference_n::continueRecurrenceTermwise(sequence, coefficients, count);
+    }));
+
+    for(const auto &[name, terms] : vector<pair<string, sequence_t>> {
+        { "recurrence of order 4", sequence },
+        { "arithmetic", generate("3*n + 2", { 40 }) },
+        { "periodic pattern", generate({ "s(0) = 1", "s(2*n + 1) = s(n-1) + 5", "s(2*n) = s(n-1) - 3" }, { 40 }) } })
+    {
+        report(fmt::format("solve(), {}", name), count, measure([&]() {
+            solve(terms, { count });
+        }));
+    }
+}
+
+void benchmarkBatchSolver(const size_t sequenceCount)
+{
+    const vector<string> rules { "3*n + 2", "2^n", "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" };
+
+    vector<sequence_t> sequences;
+    for(size_t i = 0; i < sequenceCount; i++)
+    {
+        const double scale = 1.0 + static_cast<double>(i % 7);
+        sequence_t sequence = i % 3 == 2 ? generate(vector<string>(rules.begin() + 2, rules.end()), { 10 }) :
+            generate(rules[i % 3], { 10 });
+        for(auto &term : sequence)
+            term *= scale;
+        sequences.push_back(std::move(sequence));
+    }
+
+    const size_t cores = std::max<size_t>(thread::hardware_concurrency(), 1);
+
+    fmt::print("Solver: batch of {} sequences of 10 terms on {} {}\n", sequenceCount, cores, cores == 1 ? "core" : "cores");
+
+    const double loopSeconds = measure([&]() {
+        for(const auto &sequence : sequences)
+            solve(sequence, { 3 });
+    });
+    report("solve() per sequence", sequenceCount, loopSeconds, "sequences");
+
+    const double batchSeconds = measure([&]() {
+        solveBatch(sequences, { 3 });
+    });
+    report("solveBatch()", sequenceCount, batchSeconds, "sequences");
+    report("solveBatch() per core", sequenceCount, batchSeconds * cores, "sequences");
+
+    // the solutions of a batch are released with the arena at once instead of prediction by prediction
+    report("solveBatch() on one worker", sequenceCount, measure([&]() {
+        solverContext_t context { 3 };
+        context.workerCount = 1;
+        solveBatch(sequences, context);
+    }), "sequences");
+
+    report("solveBatch() on one worker into an arena", sequenceCount, measure([&]() {
+        std::pmr::monotonic_buffer_resource arena;
+        solverContext_t context { 3 };
+        context.workerCount = 1;
+        context.memoryResource = &arena;
+        solveBatch(sequences, context);
+    }), "sequences");
+}
+
+void benchmarkSolutionCache(const size_t sequenceCount)
+{
+    // a few sequences of 200 terms that come back over and over, partly as scaled copies, which are cached apart
+    const vector<sequence_t> sequences {
+        generate({ "s(0) = 1", "s(4n+3) = s(n-1) + 4", "s(4n) = s(n-1) + 2" }, { 200 }),
+        generate("sin(0.3*n) + 0.5*cos(0.7*n)", { 200 }),
+        generate("3*n + 2", { 200 })
+    };
+
+    fmt::print("Solver: {} repeated and scaled sequences of 200 terms\n", sequenceCount);
+
+    auto run = [&]() {
+        for(size_t i = 0; i < sequenceCount; i++)
+        {
+            sequence_t sequence = sequences[i % sequences.size()];
+            for(auto &term : sequence)
+                term *= 1.0 + static_cast<double>(i % 5);
+            solve(sequence, { 3, true, 20 });
+        }
+    };
+
+    report("solve() without solution cache", sequenceCount, measure(run), "sequences");
+
+    clearSolutionCache();
+    setSolutionCacheCapacity(64);
+    report("solve() with solution cache", sequenceCount, measure(run), "sequences");
+
+    const auto statistics = solutionCacheStatistics();
+    fmt::print("  {} hits, {} misses\n", statistics.hits, statistics.misses);
+    setSolutionCacheCapacity(0);
+}
+
+void benchmarkSolutionStore(const size_t sequenceCount)
+{
+    const string path = (filesystem::temp_directory_path() / "sequencer_benchmark_store.bin").string();
+    filesystem::remove(path);
+
+    vector<sequence_t> sequences;
+    for(size_t i = 0; i < sequenceCount; i++)
+        sequences.push_back(generate("sin(0.3*n) + 0.5*cos(0.7*n) + " + to_string(i), { 200 }));
+
+    fmt::print("Solver: {} distinct sequences of 200 terms in a solution store\n", sequenceCount);
+
+    auto run = [&]() {
+        for(const auto &sequence : sequences)
+            solve(sequence, { 3, true, 20 });
+    };
+
+    report("solve() without solution store", sequenceCount, measure(run), "sequences");
+
+    openSolutionStore(path, true);
+    report("solve() filling the solution store", sequenceCount, measure(run), "sequences");
+    closeSolutionStore();
+
+    // a later process that opens the filled store for reading
+    openSolutionStore(path, false);
+    report("solve() with filled solution store", sequenceCount, measure(run), "sequences");
+    closeSolutionStore();
+
+    filesystem::remove(path);
+}
+
+void benchmarkOnlineSolver(const size_t length)
+{
+    const auto sequence = generate("sin(0.3*n) + 0.5*cos(0.7*n) + mod(n, 3)", { length });
+
+    fmt::print("Solver: {} terms arriving one by one\n", length);
+
+    report("solve() on every prefix", length, measure([&]() {
+        sequence_t prefix;
+        for(const double term : sequence)
+        {
+            prefix.push_back(term);
+            solve(prefix, { 3 });
+        }
+    }));
+
+    report("onlineSolver_c::append()", length, measure([&]() {
+        onlineSolver_c solver({ 3 });
+        for(const double term : sequence)
+            solver.append(term);
+    }));
+
+    report("onlineSolver_c::append() and solution()", length, measure([&]() {
+        onlineSolver_c solver({ 3 });
+        for(const double term : sequence)
+        {
+            solver.append(term);
+            solver.solution();
+        }
+    }));
+}
+
+// the time per term of append() and solution() has to stay the same as the sequence grows, with and without a period
+void benchmarkOnlineScaling(const vector<size_t> &lengths)
+{
+    for(const string rule : { "sin(0.3*n) + 0.5*cos(0.7*n)", "mod(n, 7) + 2*mod(n, 3)" })
+    {
+        fmt::print("Solver: online scaling of {}\n", rule);
+
+        for(const size_t length : lengths)
+        {
+            const auto sequence = generate(rule, { length });
+
+            report("onlineSolver_c::append()", length, measure([&]() {
+                onlineSolver_c solver({ 3 });
+                for(const double term : sequence)
+                    solver.append(term);
+            }));
+
+            // a periodic solution holds a pattern per offset of the largest gap, which grows with the terms
+            if(rule.starts_with("mod"))
+                continue;
+
+            report("onlineSolver_c::append() and solution()", length, measure([&]() {
+                onlineSolver_c solver({ 3 });
+                for(const double term : sequence)
+                {
+                    solver.append(term);
+                    solver.solution();
+                }
+            }));
+        }
+    }
+}
+
+void benchmarkWindowedSolver(const size_t length, const size_t windowSize)
+{
+    const auto sequence = generate("sin(0.3*n) + 0.5*cos(0.7*n)", { length });
+
+    fmt::print("Solver: window of {} terms sliding over {} terms\n", windowSize, length);
+
+    report("solve() on every window", length, measure([&]() {
+        for(size_t end = 1; end <= sequence.size(); end++)
+            solve(sequence_t(sequence.begin() + (end > windowSize ? end - windowSize : 0), sequence.begin() + end), { 3 });
+    }));
+
+    report("windowedSolver_c::push() and solution()", length, measure([&]() {
+        windowedSolver_c solver(windowSize, { 3 });
+        for(const double term : sequence)
+        {
+            solver.push(term);
+            solver.solution();
+        }
+    }));
+}
+
+int main(int argc, char* argv[])
+{
+    vector<size_t> lengths;
+
+    // the lengths of the sequences to be generated can be given as arguments
+    for(int i = 1; i < argc; i++)
+        lengths.push_back(std::stoull(argv[i]));
+    if(lengths.empty())
+        lengths.push_back(1000000);
+
+    benchmarkGenerator(lengths);
+    benchmarkExplicitGenerator(lengths);
+    benchmarkShortGeneration(10000);
+    benchmarkSolver({ 20, 200, 2000 });
+    benchmarkParallelDetectors(200000);
+    benchmarkArtefacts(1000000);
+    benchmarkPeriodicSolver(100000);
+    benchmarkPolynomialSolver(1000);
+    benchmarkLongContinuation(1000000);
+    benchmarkBatchSolver(100000);
+    benchmarkSolutionCache(10000);
+    benchmarkSolutionStore(10000);
+    benchmarkOnlineSolver(5000);
+    benchmarkOnlineScaling({ 10000, 100000 });
+    benchmarkWindowedSolver(100000, 200);
+
+    return 0;
+}
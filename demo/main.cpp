@@ -12,7 +12,7 @@ using namespace std;
 using namespace sequencer_n;
 
 void printSolution(const solution_t &solution, const sequence_t &sequence, const sequence_t &continuation, bool omitPredictedRules);
-std::ostream& operator<<(std::ostream &os, const sequence_t &sequence);
+std::ostream& operator<<(std::ostream &os, std::span<const double> sequence);
 
 int main(int argc, char* argv[])
 {
@@ -155,6 +155,7 @@ void printSolution(const solution_t &solution, const sequence_t &sequence, const
 
         bool anyPredictionValid = false;
         sequence_t combined;
+        const toleranceModel_c tolerance(continuation);
 
         for(const auto &prediction : solution.predictions)
         {
@@ -165,8 +166,8 @@ void printSolution(const solution_t &solution, const sequence_t &sequence, const
                 bool predictionApproximatelyEqual = false;
                 if(!continuation.empty())
                 {
-                    const double epsilon = calculateSuitableEpsilon(continuation);
-                    predictionApproximatelyEqual = approximatelyEqualLeastCommon(continuation, prediction.predictedContinuation, epsilon);
+                    predictionApproximatelyEqual = approximatelyEqualLeastCommon(continuation, prediction.predictedContinuation,
+                        tolerance.sequenceEpsilon());
                     anyPredictionValid |= predictionApproximatelyEqual;
 
                     cout << (predictionApproximatelyEqual ? " \033[32mvalidated\033[0m" : " \033[31minvalidated\033[0m") << endl;
@@ -176,7 +177,7 @@ void printSolution(const solution_t &solution, const sequence_t &sequence, const
 
                 if(!omitPredictedRules)
                 {
-                    for(auto const &description : prediction.descriptionList)
+                    for(auto const &description : describe(prediction))
                         cout << "  " << description << endl;
                 }
 
@@ -201,7 +202,7 @@ void printSolution(const solution_t &solution, const sequence_t &sequence, const
         cout << "\033[94mCould not predict continuation of the given sequence\033[0m" << endl;
 }
 
-std::ostream& operator<<(std::ostream &os, const sequence_t &sequence)
+std::ostream& operator<<(std::ostream &os, std::span<const double> sequence)
 {
     if(sequence.size() == 0) os << "{ }";
     else
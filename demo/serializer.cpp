@@ -1,3 +1,5 @@
+#include <sstream>
+#include <stdexcept>
 #include <sequencer/types.h>
 #include "serializer.h"
 
@@ -46,7 +48,7 @@ namespace YAML
             stringstream ss;
             ss << "givenElementCount + requiredPredictedContinuationCount exceeds element count in sequence for sequence solver task \"" <<
                 rhs.name << "\"";
-            throw exception(ss.str().c_str());
+            throw runtime_error(ss.str());
         }
 
         rhs.testSequence.insert(rhs.testSequence.begin(), rhs.sequence.begin(), rhs.sequence.begin() + rhs.givenElementCount);
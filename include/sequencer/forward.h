@@ -1,22 +1,30 @@
 #ifndef SEQUENCER_FORWARD_H
 #define SEQUENCER_FORWARD_H
 
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 
 namespace sequencer_n
 {
     enum class sequenceType_t;
     enum class operation_t;
+    enum class expressionBackend_t;
+    enum class detector_t : uint32_t;
+    enum class ruleForm_t;
 
     struct namedSequence_t;
     struct pattern_t;
+    struct predictionRule_t;
     struct prediction_t;
     struct solution_t;
     struct generatorContext_t;
+    struct ruleCacheStatistics_t;
+    struct solutionCacheStatistics_t;
     struct solverContext_t;
 
     using sequence_t = std::vector<double>;
-    using predictions_t = std::vector<prediction_t>;
+    using predictions_t = std::pmr::vector<prediction_t>;
 }
 
 #endif //SEQUENCER_FORWARD_H
@@ -1,17 +1,88 @@
 #ifndef SEQUENCER_GENERATOR_H
 #define SEQUENCER_GENERATOR_H
 
+#include <iterator>
+#include <memory>
+#include <optional>
 #include <string>
 #include "dll.h"
 #include "forward.h"
 
 namespace sequencer_n
 {
+    class generator_c;
+
     sequence_t SEQUENCER_CPP_API generate(const std::vector<std::string> &description, const generatorContext_t &context);
-    
+
     inline sequence_t generate(const std::string &description, const generatorContext_t &context) {
         return generate(std::vector<std::string> { description }, context);
     }
+
+    // returns the term at the given index without generating the whole sequence: explicit rules are evaluated directly
+    // and recurrences that are linear in the preceding terms jump ahead in O(order^3 log index)
+    std::optional<double> SEQUENCER_CPP_API generateTerm(const std::vector<std::string> &description, const size_t index);
+
+    // compiled rule sets are kept in a least recently used cache keyed by their description, so that generating from
+    // the same rules again skips parsing and validation; a capacity of 0 disables the cache
+    void SEQUENCER_CPP_API setRuleCacheCapacity(const size_t capacity);
+    void SEQUENCER_CPP_API clearRuleCache();
+    ruleCacheStatistics_t SEQUENCER_CPP_API ruleCacheStatistics();
+
+    // input range that generates the terms of a sequence on demand, starting at the given index; only the terms
+    // that the rules look back to are kept in memory, so the range is unbounded unless the rules give constants only
+    class SEQUENCER_CPP_API lazySequence_c
+    {
+    public:
+        class iterator_c
+        {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = double;
+            using difference_type = std::ptrdiff_t;
+
+            iterator_c() = default;
+            explicit iterator_c(lazySequence_c *sequence) : sequence(sequence) {}
+
+            inline double operator*() const {
+                return sequence->term;
+            }
+
+            inline iterator_c &operator++() {
+                sequence->advance();
+                return *this;
+            }
+
+            inline void operator++(int) {
+                sequence->advance();
+            }
+
+            inline bool operator==(std::default_sentinel_t) const {
+                return sequence == nullptr || sequence->exhausted;
+            }
+
+        private:
+            lazySequence_c *sequence = nullptr;
+        };
+
+        lazySequence_c(const std::vector<std::string> &description, const size_t startIndex = 0);
+        lazySequence_c(lazySequence_c &&other) noexcept;
+        lazySequence_c &operator=(lazySequence_c &&other) noexcept;
+        ~lazySequence_c();
+
+        iterator_c begin();
+
+        inline std::default_sentinel_t end() const {
+            return std::default_sentinel;
+        }
+
+    private:
+        void advance();
+
+        std::unique_ptr<generator_c> generator;
+        double term = 0.0;
+        bool started = false;
+        bool exhausted = true;
+    };
 }
 
 #endif //SEQUENCER_GENERATOR_H
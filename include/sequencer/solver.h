@@ -2,12 +2,83 @@
 #define SEQUENCER_SOLVER_H
 
 #include <functional>
+#include <memory>
+#include <span>
+#include <string>
 #include "dll.h"
 #include "forward.h"
 
 namespace sequencer_n
 {
     solution_t SEQUENCER_CPP_API solve(const sequence_t &sequence, const solverContext_t &context);
+
+    // renders the rule of a prediction as text only when asked for it: the initial terms of a recurrence followed by
+    // the recurrence, a closed form or one line per periodic pattern
+    std::vector<std::string> SEQUENCER_CPP_API describe(const prediction_t &prediction);
+
+    // solves many sequences on a pool of workers that steal sequences from each other once they run out of work,
+    // where each worker reuses its buffers from one sequence to the next; solutions keep the order of the sequences
+    std::vector<solution_t> SEQUENCER_CPP_API solveBatch(std::span<const sequence_t> sequences, const solverContext_t &context);
+
+    // opt-in least recently used cache in front of solve() and solveBatch(), keyed by the exact terms and the context
+    // fields that affect the detectors, so that a hit gives the same solution as solving again; the predictions are
+    // derived from the cached detections for any requiredPredictedContinuationCount. Terms that only agree within the
+    // tolerance, and scaled or shifted copies, are solved again rather than taken from the cache: the tolerance and
+    // the detectors depend on the magnitude of the terms, so that a copy may have other detections. A capacity of 0
+    // disables the cache (default)
+    void SEQUENCER_CPP_API setSolutionCacheCapacity(const size_t capacity);
+    void SEQUENCER_CPP_API clearSolutionCache();
+    solutionCacheStatistics_t SEQUENCER_CPP_API solutionCacheStatistics();
+
+    // solution store in a memory mapped file that solve() and solveBatch() look up after the solution cache, under the
+    // same key, so that detections outlive the process and are shared between processes: any number of processes
+    // open the file for reading, one of them may open it writable and adds what it solves until the file is full.
+    // A new file is created with the given size in bytes, and a file without a finished store of this version is started
+    // over if it is opened writable; returns false if the file cannot be opened
+    bool SEQUENCER_CPP_API openSolutionStore(const std::string &path, const bool writable, const size_t capacity = 64 << 20);
+    void SEQUENCER_CPP_API closeSolutionStore();
+
+    // solves a sequence whose terms arrive one by one: the differences and ratios between terms, the periodic patterns
+    // that still hold and the minimal linear recurrence are updated per appended term instead of being derived from
+    // all terms again, and solution() gives what solve() gives for the terms appended so far. A periodic solution holds
+    // a pattern per offset of the largest gap that holds, so its solution() takes time linear in the terms
+    class SEQUENCER_CPP_API onlineSolver_c
+    {
+    public:
+        explicit onlineSolver_c(const solverContext_t &context);
+        onlineSolver_c(onlineSolver_c &&other) noexcept;
+        onlineSolver_c &operator=(onlineSolver_c &&other) noexcept;
+        ~onlineSolver_c();
+
+        void append(const double term);
+        solution_t solution() const;
+        const sequence_t &sequence() const;
+
+    private:
+        struct state_t;
+        std::unique_ptr<state_t> state;
+    };
+
+    // solves a window of the given size that slides over a sequence: every pushed term drops the oldest one once the
+    // window is full, the differences and ratios between terms are updated at both ends and the minimal linear
+    // recurrence is only searched for again once the newest term breaks it, and solution() gives what solve() gives
+    // for the terms in the window
+    class SEQUENCER_CPP_API windowedSolver_c
+    {
+    public:
+        windowedSolver_c(const size_t windowSize, const solverContext_t &context);
+        windowedSolver_c(windowedSolver_c &&other) noexcept;
+        windowedSolver_c &operator=(windowedSolver_c &&other) noexcept;
+        ~windowedSolver_c();
+
+        void push(const double term);
+        solution_t solution() const;
+        std::span<const double> window() const;
+
+    private:
+        struct state_t;
+        std::unique_ptr<state_t> state;
+    };
 }
 
 #endif //SEQUENCER_SOLVER_H
@@ -1,7 +1,10 @@
 #ifndef SEQUENCER_TYPES_H
 #define SEQUENCER_TYPES_H
 
+#include <cstdint>
 #include <functional>
+#include <memory_resource>
+#include "dll.h"
 #include "forward.h"
 
 namespace sequencer_n
@@ -23,7 +26,9 @@ namespace sequencer_n
         SQUARE, 
         CUBIC, 
         LINEAR_RECURSIVE,
-        MIXED
+        MIXED,
+        // polynomial of degree 4 or higher, or a quadratic that is neither TRIANGULAR nor SQUARE; cubic ones are CUBIC
+        POLYNOMIAL
     };
 
     enum class operation_t
@@ -33,6 +38,32 @@ namespace sequencer_n
         MULTIPLICATION
     };
 
+    enum class expressionBackend_t
+    {
+        MUPARSER,
+        COMPILED
+    };
+
+    // detectors that solve() runs to find predictions, combined as a bit mask
+    enum class detector_t : uint32_t
+    {
+        NONE = 0,
+        ARITHMETIC = 1 << 0,
+        GEOMETRIC = 1 << 1,
+        PERIODIC_PATTERN = 1 << 2,
+        LINEAR_RECURRENCE = 1 << 3,
+        POLYNOMIAL = 1 << 4,
+        ALL = 0xFFFFFFFF
+    };
+
+    inline constexpr detector_t operator|(const detector_t a, const detector_t b) {
+        return static_cast<detector_t>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    inline constexpr bool operator&(const detector_t a, const detector_t b) {
+        return (static_cast<uint32_t>(a) & static_cast<uint32_t>(b)) != 0;
+    }
+
     struct pattern_t
     {
         operation_t operation;
@@ -50,15 +81,61 @@ namespace sequencer_n
         }
     };
 
+    enum class ruleForm_t
+    {
+        NONE,
+        // patterns applied to the preceding term in turn, the one at (n - 1) % gap yields s(n)
+        PATTERNS,
+        // s(n) = coefficients[0] s(n-order) + ... + coefficients[order-1] s(n-1), from the first order terms
+        RECURRENCE,
+        // the polynomial through the initial terms, whose count is one more than its degree
+        POLYNOMIAL
+    };
+
+    // what a prediction continues the sequence by, which describe() renders as text on demand
+    struct predictionRule_t
+    {
+        predictionRule_t() = default;
+        explicit predictionRule_t(std::pmr::memory_resource *resource) :
+            patterns(resource), coefficients(resource), initialTerms(resource) {}
+
+        ruleForm_t form = ruleForm_t::NONE;
+        std::pmr::vector<pattern_t> patterns;
+        std::pmr::vector<double> coefficients;
+        std::pmr::vector<double> initialTerms;
+
+        inline bool operator==(const predictionRule_t &other) const {
+            return form == other.form && patterns == other.patterns && coefficients == other.coefficients &&
+                initialTerms == other.initialTerms;
+        }
+
+        inline bool operator!=(const predictionRule_t &other) const {
+            return !(operator==(other));
+        }
+    };
+
+    /* the continuation and the predictions of a solution live in the memory resource of the solution, unlike in earlier
+     * releases, which changes the layout of this struct and of solution_t: code built against them has to be rebuilt.
+     * Code that took the continuation for a sequence_t copies it by continuation(), and the list of descriptions is
+     * rendered by describe(prediction) instead of being kept in a member */
     struct prediction_t
     {
-        sequence_t predictedContinuation;
-        std::vector<std::string> descriptionList;
+        prediction_t() = default;
+        explicit prediction_t(std::pmr::memory_resource *resource) : predictedContinuation(resource), rule(resource) {}
+
+        std::pmr::vector<double> predictedContinuation;
+        predictionRule_t rule;
         sequenceType_t sequenceType = sequenceType_t::UNSPECIFIED;
 
+        inline sequence_t continuation() const {
+            return sequence_t(predictedContinuation.begin(), predictedContinuation.end());
+        }
+
+        // the former list of descriptions, which are now rendered from the rule on demand
+        [[deprecated("use describe(prediction)")]] std::vector<std::string> SEQUENCER_CPP_API descriptionList() const;
+
         inline bool operator==(const prediction_t &other) const {
-            return predictedContinuation == other.predictedContinuation && 
-                descriptionList == other.descriptionList && sequenceType == other.sequenceType;
+            return predictedContinuation == other.predictedContinuation && rule == other.rule && sequenceType == other.sequenceType;
         }
 
         inline bool operator!=(const prediction_t &other) const {
@@ -83,6 +160,26 @@ namespace sequencer_n
     {
         size_t sequenceLength = 1;
         size_t startIndex = 0;
+        // number of threads that explicit rules are generated on in disjoint index ranges; 0 uses all hardware threads
+        size_t workerCount = 1;
+        // rules are evaluated by muparser or compiled into closures that look up preceding terms directly
+        expressionBackend_t expressionBackend = expressionBackend_t::MUPARSER;
+    };
+
+    struct ruleCacheStatistics_t
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    struct solutionCacheStatistics_t
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t size = 0;
+        size_t capacity = 0;
     };
 
     struct solverContext_t
@@ -90,6 +187,18 @@ namespace sequencer_n
         size_t requiredPredictedContinuationCount = 1;
         bool allowMultiplePredictions = false;
         int maximumRecurrenceOrder = 5;
+        detector_t enabledDetectors = detector_t::ALL;
+        // runs the detectors side by side on a pool of threads that outlives the solve if multiple predictions are
+        // allowed; the solution stays the same
+        bool parallelDetectors = false;
+        // number of threads that solveBatch() spreads the sequences over; 0 uses all hardware threads
+        size_t workerCount = 0;
+        // highest degree the polynomial detector looks for, which needs at least degree + 2 terms
+        int maximumPolynomialDegree = 4;
+        /* memory the predictions of a solution are allocated from, e.g. a std::pmr::monotonic_buffer_resource that a
+         * whole batch is released with at once; it has to outlive the solutions and, for solveBatch() on more than one
+         * worker, be thread-safe like std::pmr::synchronized_pool_resource. nullptr takes the default resource */
+        std::pmr::memory_resource *memoryResource = nullptr;
     };
 }
 
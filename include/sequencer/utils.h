@@ -2,13 +2,44 @@
 #define SEQUENCER_UTILS_H
 
 #include <cmath>
+#include <span>
 #include "dll.h"
 #include "forward.h"
 
 namespace sequencer_n
 {
+    /* tolerances for comparing terms, where the epsilon of a magnitude is 10^-5 times the magnitude rounded to a power
+     * of ten. The epsilon is looked up in a table by binary exponent, which is built once and holds the epsilon below
+     * and above the power of ten that a binary exponent may straddle; only numbers right at such a boundary, zero,
+     * subnormal and non-finite numbers go through log10 and pow. A model of a sequence compares whole spans of
+     * terms against the epsilon of its last term */
+    class SEQUENCER_CPP_API toleranceModel_c
+    {
+    public:
+        toleranceModel_c() = default;
+        explicit toleranceModel_c(std::span<const double> sequence);
+
+        static double epsilon(const double a);
+
+        // whether both spans are equally long and approximately equal element by element under the given epsilon
+        static bool allEqual(std::span<const double> a, std::span<const double> b, const double epsilon);
+        // whether every term is virtually integer under its own epsilon
+        static bool allIntegers(std::span<const double> terms);
+
+        inline double sequenceEpsilon() const {
+            return referenceEpsilon;
+        }
+
+        inline bool allEqual(std::span<const double> a, std::span<const double> b) const {
+            return allEqual(a, b, referenceEpsilon);
+        }
+
+    private:
+        double referenceEpsilon = 0.0;
+    };
+
     inline double calculateSuitableEpsilon(const double a) {
-        return std::pow(10, std::round(std::log10(std::abs(a))) - 5.0);
+        return toleranceModel_c::epsilon(a);
     }
 
     inline double calculateSuitableEpsilon(const sequence_t &sequence) {
@@ -19,6 +50,10 @@ namespace sequencer_n
         return std::fabs(a - b) <= ((std::fabs(a) < std::fabs(b) ? std::fabs(b) : std::fabs(a)) * epsilon);
     }
 
+    bool SEQUENCER_CPP_API approximatelyEqual(std::span<const double> a, std::span<const double> b, const double epsilon);
+    bool SEQUENCER_CPP_API approximatelyEqualLeastCommon(std::span<const double> standard, std::span<const double> suitor, const double epsilon);
+
+    // the former signatures, kept so that callers built against them still link; they forward to the spans
     bool SEQUENCER_CPP_API approximatelyEqual(const sequence_t &a, const sequence_t &b, const double epsilon);
     bool SEQUENCER_CPP_API approximatelyEqualLeastCommon(const sequence_t &standard, const sequence_t &suitor, const double epsilon);
 
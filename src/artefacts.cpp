@@ -0,0 +1,197 @@
+#include <cfloat>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    include <immintrin.h>
+#    ifdef _MSC_VER
+#        include <intrin.h>
+#        define SEQUENCER_AVX2
+#    else
+#        define SEQUENCER_AVX2 __attribute__((target("avx2")))
+#    endif
+#endif
+
+#include "artefacts.h"
+
+namespace sequencer_n
+{
+    /* for every |a| within the range, calculateSuitableEpsilon(a) / |a| lies between 10^-5.5 and 10^-4.5, as the
+     * epsilon is |a| rounded to a power of ten and divided by 10^5; the margins cover the rounding of log10, pow
+     * and the products. Outside the range the products below could leave the normal numbers */
+    constexpr double RANGE_LOW = 1.0e-140;
+    constexpr double RANGE_HIGH = 1.0e140;
+    constexpr double EPSILON_RATIO_LOW = 3.1622776601683795e-6 * (1.0 - 1.0e-9);
+    constexpr double EPSILON_RATIO_HIGH = 3.1622776601683795e-5 * (1.0 + 1.0e-9);
+
+    // checks the lanes that were not decided by the bounds exactly
+    template<typename check_t>
+    inline bool holdsInAllLanes(const unsigned decided, const unsigned lanes, const check_t &check)
+    {
+        for(unsigned lane = 0; lane < lanes; lane++)
+            if(!(decided >> lane & 1) && !check(lane))
+                return false;
+        return true;
+    }
+
+    // the first artefact and the two terms it lies between, after which the sweeps compare every artefact to the
+    // one before it
+    artefactFlags_t extractFirstArtefact(std::span<const double> sequence, double *differences, double *ratios)
+    {
+        artefactFlags_t flags;
+        differences[0] = sequence[1] - sequence[0];
+        ratios[0] = sequence[1] / sequence[0];
+        flags.containsDecimals = !virtuallyInteger(sequence[0]) || !virtuallyInteger(sequence[1]);
+        return flags;
+    }
+
+    // the artefact between the terms at index and index + 1 for index >= 1
+    inline void extractArtefact(std::span<const double> sequence, double *differences, double *ratios, const size_t index,
+        artefactFlags_t &flags)
+    {
+        differences[index] = sequence[index + 1] - sequence[index];
+        ratios[index] = sequence[index + 1] / sequence[index];
+
+        flags.constantDifference = flags.constantDifference && sameArtefact(differences[index - 1], differences[index]);
+        flags.constantRatio = flags.constantRatio && sameArtefact(ratios[index - 1], ratios[index]);
+        flags.containsDecimals = flags.containsDecimals || !virtuallyInteger(sequence[index + 1]);
+    }
+
+    artefactFlags_t extractArtefactsScalar(std::span<const double> sequence, double *differences, double *ratios)
+    {
+        if(sequence.size() < 2)
+            return {};
+
+        auto flags = extractFirstArtefact(sequence, differences, ratios);
+        for(size_t index = 1; index + 1 < sequence.size(); index++)
+            extractArtefact(sequence, differences, ratios, index, flags);
+
+        return flags;
+    }
+
+#ifdef SEQUENCER_AVX2
+    bool avx2Supported()
+    {
+#ifdef _MSC_VER
+        int registers[4];
+        __cpuid(registers, 0);
+        if(registers[0] < 7)
+            return false;
+
+        // the operating system has to save the upper halves of the registers as well
+        __cpuid(registers, 1);
+        if((registers[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(registers, 7, 0);
+        return (registers[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    // lanes in which sameArtefact(previous, current) surely holds and surely fails
+    SEQUENCER_AVX2 inline void classifyAvx2(const __m256d previous, const __m256d current, unsigned &holds, unsigned &fails)
+    {
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        const __m256d magnitude = _mm256_andnot_pd(sign, current);
+        const __m256d larger = _mm256_max_pd(magnitude, _mm256_andnot_pd(sign, previous));
+        const __m256d distance = _mm256_andnot_pd(sign, _mm256_sub_pd(current, previous));
+        const __m256d scale = _mm256_mul_pd(larger, magnitude);
+
+        const __m256d inRange = _mm256_and_pd(_mm256_cmp_pd(magnitude, _mm256_set1_pd(RANGE_LOW), _CMP_GE_OQ),
+            _mm256_cmp_pd(larger, _mm256_set1_pd(RANGE_HIGH), _CMP_LE_OQ));
+        const __m256d equal = _mm256_and_pd(_mm256_cmp_pd(current, previous, _CMP_EQ_OQ),
+            _mm256_cmp_pd(magnitude, _mm256_set1_pd(DBL_MAX), _CMP_LE_OQ));
+
+        holds = static_cast<unsigned>(_mm256_movemask_pd(_mm256_or_pd(equal, _mm256_and_pd(inRange,
+            _mm256_cmp_pd(distance, _mm256_mul_pd(scale, _mm256_set1_pd(EPSILON_RATIO_LOW)), _CMP_LE_OQ)))));
+        fails = static_cast<unsigned>(_mm256_movemask_pd(_mm256_and_pd(inRange,
+            _mm256_cmp_pd(distance, _mm256_mul_pd(scale, _mm256_set1_pd(EPSILON_RATIO_HIGH)), _CMP_GT_OQ))));
+    }
+
+    /* lanes whose terms are surely virtually integer and surely not; the integer nearest to a term is rounded to even
+     * on a tie, which leaves the distance to it the same as std::round does, and the larger magnitude of the two
+     * lies between that of the term and half more */
+    SEQUENCER_AVX2 inline void classifyIntegersAvx2(const __m256d terms, unsigned &integral, unsigned &decimal)
+    {
+        const __m256d sign = _mm256_set1_pd(-0.0);
+        const __m256d nearest = _mm256_round_pd(terms, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        const __m256d magnitude = _mm256_andnot_pd(sign, terms);
+        const __m256d distance = _mm256_andnot_pd(sign, _mm256_sub_pd(terms, nearest));
+
+        const __m256d inRange = _mm256_and_pd(_mm256_cmp_pd(magnitude, _mm256_set1_pd(RANGE_LOW), _CMP_GE_OQ),
+            _mm256_cmp_pd(magnitude, _mm256_set1_pd(RANGE_HIGH), _CMP_LE_OQ));
+        const __m256d equal = _mm256_and_pd(_mm256_cmp_pd(terms, nearest, _CMP_EQ_OQ),
+            _mm256_cmp_pd(magnitude, _mm256_set1_pd(DBL_MAX), _CMP_LE_OQ));
+        const __m256d lowerScale = _mm256_mul_pd(magnitude, magnitude);
+        const __m256d upperScale = _mm256_mul_pd(_mm256_add_pd(magnitude, _mm256_set1_pd(0.5)), magnitude);
+
+        integral = static_cast<unsigned>(_mm256_movemask_pd(_mm256_or_pd(equal, _mm256_and_pd(inRange,
+            _mm256_cmp_pd(distance, _mm256_mul_pd(lowerScale, _mm256_set1_pd(EPSILON_RATIO_LOW)), _CMP_LE_OQ)))));
+        decimal = static_cast<unsigned>(_mm256_movemask_pd(_mm256_and_pd(inRange,
+            _mm256_cmp_pd(distance, _mm256_mul_pd(upperScale, _mm256_set1_pd(EPSILON_RATIO_HIGH)), _CMP_GT_OQ))));
+    }
+
+    SEQUENCER_AVX2 artefactFlags_t extractArtefactsAvx2(std::span<const double> sequence, double *differences, double *ratios)
+    {
+        const double *terms = sequence.data();
+        const size_t count = sequence.size() - 1;
+        auto flags = extractFirstArtefact(sequence, differences, ratios);
+
+        size_t index = 1;
+        for(; index + 4 <= count; index += 4)
+        {
+            const __m256d before = _mm256_loadu_pd(terms + index - 1);
+            const __m256d at = _mm256_loadu_pd(terms + index);
+            const __m256d after = _mm256_loadu_pd(terms + index + 1);
+            const __m256d difference = _mm256_sub_pd(after, at);
+            const __m256d ratio = _mm256_div_pd(after, at);
+            _mm256_storeu_pd(differences + index, difference);
+            _mm256_storeu_pd(ratios + index, ratio);
+
+            unsigned holds = 0, fails = 0;
+            if(flags.constantDifference)
+            {
+                classifyAvx2(_mm256_sub_pd(at, before), difference, holds, fails);
+                flags.constantDifference = fails == 0 && holdsInAllLanes(holds, 4, [differences, index](const unsigned lane) {
+                    return sameArtefact(differences[index + lane - 1], differences[index + lane]);
+                });
+            }
+
+            if(flags.constantRatio)
+            {
+                classifyAvx2(_mm256_div_pd(at, before), ratio, holds, fails);
+                flags.constantRatio = fails == 0 && holdsInAllLanes(holds, 4, [ratios, index](const unsigned lane) {
+                    return sameArtefact(ratios[index + lane - 1], ratios[index + lane]);
+                });
+            }
+
+            if(!flags.containsDecimals)
+            {
+                classifyIntegersAvx2(after, holds, fails);
+                flags.containsDecimals = fails != 0 || !holdsInAllLanes(holds, 4, [terms, index](const unsigned lane) {
+                    return virtuallyInteger(terms[index + lane + 1]);
+                });
+            }
+        }
+
+        for(; index < count; index++)
+            extractArtefact(sequence, differences, ratios, index, flags);
+
+        return flags;
+    }
+#endif
+
+    artefactFlags_t extractArtefacts(std::span<const double> sequence, double *differences, double *ratios)
+    {
+        if(sequence.size() < 2)
+            return {};
+
+#if defined(SEQUENCER_AVX2)
+        static const bool avx2 = avx2Supported();
+        return avx2 ? extractArtefactsAvx2(sequence, differences, ratios) : extractArtefactsScalar(sequence, differences, ratios);
+#else
+        return extractArtefactsScalar(sequence, differences, ratios);
+#endif
+    }
+}
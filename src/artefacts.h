@@ -0,0 +1,29 @@
+#ifndef SEQUENCER_ARTEFACTS_H
+#define SEQUENCER_ARTEFACTS_H
+
+#include <span>
+#include "sequencer/utils.h"
+
+namespace sequencer_n
+{
+    // whether two neighbouring differences or ratios count as the same, within the tolerance of the newer one
+    inline bool sameArtefact(const double previous, const double current) {
+        return approximatelyEqual(current, previous, calculateSuitableEpsilon(current));
+    }
+
+    struct artefactFlags_t
+    {
+        bool constantDifference = true;
+        bool constantRatio = true;
+        bool containsDecimals = false;
+    };
+
+    /* writes the differences and ratios between neighbouring terms into two arrays of one element less than the
+     * sequence and derives the flags from all of them in the same sweep. The sweep runs on AVX2 if the processor
+     * supports it, where most tolerance comparisons are decided by bounds on calculateSuitableEpsilon and only the
+     * lanes close to a bound fall back to the exact comparison, so that it gives the same flags as the scalar sweep */
+    artefactFlags_t SEQUENCER_CPP_API extractArtefacts(std::span<const double> sequence, double *differences, double *ratios);
+    artefactFlags_t SEQUENCER_CPP_API extractArtefactsScalar(std::span<const double> sequence, double *differences, double *ratios);
+}
+
+#endif //SEQUENCER_ARTEFACTS_H
@@ -0,0 +1,487 @@
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <vector>
+#include "expression.h"
+#include "window.h"
+
+namespace sequencer_n
+{
+    struct power_t
+    {
+        inline double operator()(const double base, const double exponent) const {
+            return std::pow(base, exponent);
+        }
+    };
+
+    struct modulo_t
+    {
+        inline double operator()(const double number, const double divisor) const {
+            return std::fmod(number, divisor);
+        }
+    };
+
+    // compiled subexpression along with what is known about it at compile time
+    struct node_t
+    {
+        expression_t evaluate;
+        bool constant = false;
+        double value = 0.0;
+
+        // set if the subexpression equals n + shift, which turns s(n + shift) into a direct window lookup
+        bool indexShift = false;
+        double shift = 0.0;
+
+        // set if the subexpression is affine in the preceding terms s(n + k) with coefficients that are constant
+        bool affine = false;
+    };
+
+    // recursive descent compiler that follows the operator precedence of muparser, from lowest to highest:
+    // ?:, ||, &&, comparisons, + -, * /, unary sign, ^ (right associative) and function calls
+    class expressionCompiler_c
+    {
+    public:
+        expressionCompiler_c(const std::string &body, const double *n, const termWindow_c *window) :
+            body(body), n(n), window(window) {}
+
+        expression_t compile()
+        {
+            node_t node = parseTernary();
+            skipSpace();
+
+            if(failed || position != body.size())
+                return {};
+
+            affine = node.affine;
+            return node.evaluate;
+        }
+
+        // whether the last compiled body is affine in the preceding terms
+        bool affine = false;
+
+    private:
+        static node_t constant(const double value)
+        {
+            node_t node;
+            node.evaluate = [value]() { return value; };
+            node.constant = true;
+            node.value = value;
+            node.affine = true;
+            return node;
+        }
+
+        template<typename operation_t>
+        static node_t binary(node_t a, node_t b)
+        {
+            if(a.constant && b.constant)
+                return constant(static_cast<double>(operation_t {}(a.value, b.value)));
+
+            // operands that are known at compile time are captured by value instead of being evaluated
+            node_t node;
+            if(b.constant)
+                node.evaluate = [a = std::move(a.evaluate), b = b.value]() { return static_cast<double>(operation_t {}(a(), b)); };
+            else if(a.constant)
+                node.evaluate = [a = a.value, b = std::move(b.evaluate)]() { return static_cast<double>(operation_t {}(a, b())); };
+            else
+                node.evaluate = [a = std::move(a.evaluate), b = std::move(b.evaluate)]() {
+                    return static_cast<double>(operation_t {}(a(), b()));
+                };
+
+            return node;
+        }
+
+        node_t indexShift(const double shift)
+        {
+            node_t node;
+            if(shift == 0.0)
+                node.evaluate = [n = n]() { return *n; };
+            else
+                node.evaluate = [n = n, shift]() { return *n + shift; };
+
+            node.indexShift = true;
+            node.shift = shift;
+            return node;
+        }
+
+        node_t fail()
+        {
+            failed = true;
+            return constant(0.0);
+        }
+
+        void skipSpace()
+        {
+            while(position < body.size() && std::isspace(static_cast<unsigned char>(body[position])))
+                position++;
+        }
+
+        bool accept(const char *token)
+        {
+            skipSpace();
+
+            const size_t length = std::char_traits<char>::length(token);
+            if(body.compare(position, length, token) != 0)
+                return false;
+
+            // a single character operator must not be the prefix of a two character one, e.g. < of <=
+            if(length == 1 && position + 1 < body.size())
+            {
+                const char next = body[position + 1];
+                if((token[0] == '<' || token[0] == '>' || token[0] == '=' || token[0] == '!') && next == '=')
+                    return false;
+                if((token[0] == '&' || token[0] == '|') && next == token[0])
+                    return false;
+            }
+
+            position += length;
+            return true;
+        }
+
+        node_t parseTernary()
+        {
+            node_t condition = parseOr();
+            if(!accept("?"))
+                return condition;
+
+            node_t a = parseTernary();
+            if(!accept(":"))
+                return fail();
+            node_t b = parseTernary();
+
+            if(condition.constant)
+                return condition.value != 0.0 ? a : b;
+
+            node_t node;
+            node.evaluate = [condition = std::move(condition.evaluate), a = std::move(a.evaluate), b = std::move(b.evaluate)]() {
+                return condition() != 0.0 ? a() : b();
+            };
+            return node;
+        }
+
+        node_t parseOr()
+        {
+            node_t node = parseAnd();
+            while(!failed && accept("||"))
+                node = binary<std::logical_or<>>(std::move(node), parseAnd());
+            return node;
+        }
+
+        node_t parseAnd()
+        {
+            node_t node = parseComparison();
+            while(!failed && accept("&&"))
+                node = binary<std::logical_and<>>(std::move(node), parseComparison());
+            return node;
+        }
+
+        node_t parseComparison()
+        {
+            node_t node = parseSum();
+            while(!failed)
+            {
+                if(accept("<="))
+                    node = binary<std::less_equal<>>(std::move(node), parseSum());
+                else if(accept(">="))
+                    node = binary<std::greater_equal<>>(std::move(node), parseSum());
+                else if(accept("=="))
+                    node = binary<std::equal_to<>>(std::move(node), parseSum());
+                else if(accept("!="))
+                    node = binary<std::not_equal_to<>>(std::move(node), parseSum());
+                else if(accept("<"))
+                    node = binary<std::less<>>(std::move(node), parseSum());
+                else if(accept(">"))
+                    node = binary<std::greater<>>(std::move(node), parseSum());
+                else
+                    break;
+            }
+            return node;
+        }
+
+        node_t parseSum()
+        {
+            node_t node = parseProduct();
+            while(!failed)
+            {
+                const bool add = accept("+");
+                if(!add && !accept("-"))
+                    break;
+
+                node_t operand = parseProduct();
+
+                // keep track of n + c so that the argument of s is recognized as a fixed distance to n
+                if(node.indexShift && operand.constant)
+                    node = indexShift(add ? node.shift + operand.value : node.shift - operand.value);
+                else if(add && node.constant && operand.indexShift)
+                    node = indexShift(node.value + operand.shift);
+                else
+                {
+                    const bool affine = node.affine && operand.affine;
+                    node = add ? binary<std::plus<>>(std::move(node), std::move(operand)) :
+                        binary<std::minus<>>(std::move(node), std::move(operand));
+                    node.affine |= affine;
+                }
+            }
+            return node;
+        }
+
+        node_t parseProduct()
+        {
+            node_t node = parseSign();
+            while(!failed)
+            {
+                // only a product with a constant factor and a quotient by a constant divisor stay affine
+                if(accept("*"))
+                {
+                    node_t factor = parseSign();
+                    const bool affine = (node.constant && factor.affine) || (factor.constant && node.affine);
+                    node = binary<std::multiplies<>>(std::move(node), std::move(factor));
+                    node.affine |= affine;
+                }
+                else if(accept("/"))
+                {
+                    node_t divisor = parseSign();
+                    const bool affine = node.affine && divisor.constant;
+                    node = binary<std::divides<>>(std::move(node), std::move(divisor));
+                    node.affine |= affine;
+                }
+                else
+                    break;
+            }
+            return node;
+        }
+
+        node_t parseSign()
+        {
+            if(accept("-"))
+            {
+                node_t operand = parseSign();
+                if(operand.constant)
+                    return constant(-operand.value);
+
+                node_t node;
+                node.evaluate = [a = std::move(operand.evaluate)]() { return -a(); };
+                node.affine = operand.affine;
+                return node;
+            }
+
+            if(accept("+"))
+                return parseSign();
+
+            return parsePower();
+        }
+
+        node_t parsePower()
+        {
+            node_t node = parsePrimary();
+            if(failed || !accept("^"))
+                return node;
+
+            node_t exponent = parseSign();
+            if(!node.constant && exponent.constant && exponent.value == 2.0)
+            {
+                node_t square;
+                square.evaluate = [a = std::move(node.evaluate)]() {
+                    const double value = a();
+                    return value * value;
+                };
+                return square;
+            }
+
+            return binary<power_t>(std::move(node), std::move(exponent));
+        }
+
+        node_t parsePrimary()
+        {
+            skipSpace();
+            if(position >= body.size())
+                return fail();
+
+            const char character = body[position];
+
+            if(accept("("))
+            {
+                node_t node = parseTernary();
+                return accept(")") ? node : fail();
+            }
+
+            // muparser reads numbers in the classic locale and knows neither hexadecimal nor infinite values, which
+            // strtod would take
+            if(std::isdigit(static_cast<unsigned char>(character)) || character == '.')
+            {
+                double value = 0.0;
+                const auto [end, error] = std::from_chars(body.data() + position, body.data() + body.size(), value);
+                if(error != std::errc())
+                    return fail();
+
+                position = end - body.data();
+                return constant(value);
+            }
+
+            if(!std::isalpha(static_cast<unsigned char>(character)) && character != '_')
+                return fail();
+
+            const size_t first = position;
+            while(position < body.size() && (std::isalnum(static_cast<unsigned char>(body[position])) || body[position] == '_'))
+                position++;
+            const std::string name = body.substr(first, position - first);
+
+            if(name == "n")
+                return indexShift(0.0);
+            if(name == "_pi")
+                return constant(3.141592653589793238462643);
+            if(name == "_e")
+                return constant(2.718281828459045235360287);
+
+            if(!accept("("))
+                return fail();
+
+            std::vector<node_t> arguments;
+            if(!accept(")"))
+            {
+                do
+                    arguments.push_back(parseTernary());
+                while(!failed && accept(","));
+
+                if(!accept(")"))
+                    return fail();
+            }
+
+            return call(name, std::move(arguments));
+        }
+
+        node_t call(const std::string &name, std::vector<node_t> arguments)
+        {
+            if(failed)
+                return fail();
+
+            if(name == "s")
+                return arguments.size() == 1 ? term(std::move(arguments[0])) : fail();
+
+            if(name == "mod")
+                return arguments.size() == 2 ? binary<modulo_t>(std::move(arguments[0]), std::move(arguments[1])) : fail();
+
+            static const std::map<std::string, double (*)(double)> unaryFunctions {
+                { "sin", [](double x) { return std::sin(x); } },
+                { "cos", [](double x) { return std::cos(x); } },
+                { "tan", [](double x) { return std::tan(x); } },
+                { "asin", [](double x) { return std::asin(x); } },
+                { "acos", [](double x) { return std::acos(x); } },
+                { "atan", [](double x) { return std::atan(x); } },
+                { "sinh", [](double x) { return std::sinh(x); } },
+                { "cosh", [](double x) { return std::cosh(x); } },
+                { "tanh", [](double x) { return std::tanh(x); } },
+                { "asinh", [](double x) { return std::asinh(x); } },
+                { "acosh", [](double x) { return std::acosh(x); } },
+                { "atanh", [](double x) { return std::atanh(x); } },
+                { "log2", [](double x) { return std::log2(x); } },
+                { "log10", [](double x) { return std::log10(x); } },
+                { "log", [](double x) { return std::log(x); } },
+                { "ln", [](double x) { return std::log(x); } },
+                { "exp", [](double x) { return std::exp(x); } },
+                { "sqrt", [](double x) { return std::sqrt(x); } },
+                { "abs", [](double x) { return std::fabs(x); } },
+                { "rint", [](double x) { return std::floor(x + 0.5); } },
+                { "sign", [](double x) { return x > 0.0 ? 1.0 : x < 0.0 ? -1.0 : 0.0; } }
+            };
+
+            auto unaryFunction = unaryFunctions.find(name);
+            if(unaryFunction != unaryFunctions.end())
+            {
+                if(arguments.size() != 1)
+                    return fail();
+
+                const auto function = unaryFunction->second;
+                if(arguments[0].constant)
+                    return constant(function(arguments[0].value));
+
+                node_t node;
+                node.evaluate = [function, a = std::move(arguments[0].evaluate)]() { return function(a()); };
+                return node;
+            }
+
+            if(arguments.empty())
+                return fail();
+
+            // muparser's functions with a variable number of arguments
+            std::vector<expression_t> operands;
+            for(auto &argument : arguments)
+                operands.push_back(std::move(argument.evaluate));
+
+            node_t node;
+            if(name == "min")
+                node.evaluate = [operands = std::move(operands)]() {
+                    double result = operands[0]();
+                    for(size_t i = 1; i < operands.size(); i++)
+                        result = std::min(result, operands[i]());
+                    return result;
+                };
+            else if(name == "max")
+                node.evaluate = [operands = std::move(operands)]() {
+                    double result = operands[0]();
+                    for(size_t i = 1; i < operands.size(); i++)
+                        result = std::max(result, operands[i]());
+                    return result;
+                };
+            else if(name == "sum" || name == "avg")
+            {
+                const double scale = name == "avg" ? 1.0 / static_cast<double>(operands.size()) : 1.0;
+                node.evaluate = [operands = std::move(operands), scale]() {
+                    double result = 0.0;
+                    for(const auto &operand : operands)
+                        result += operand();
+                    return result * scale;
+                };
+            }
+            else
+                return fail();
+
+            return node;
+        }
+
+        // s(n + k) reads the window at a fixed distance to n and s(k) a fixed index, anything else is rounded first
+        node_t term(node_t argument)
+        {
+            node_t node;
+            const termWindow_c *window = this->window;
+
+            if(argument.indexShift && argument.shift == std::round(argument.shift))
+            {
+                // n always holds an integral index while generating
+                const int shift = static_cast<int>(argument.shift);
+                node.evaluate = [n = n, window, shift]() { return window->at(static_cast<int>(*n) + shift); };
+                node.affine = shift < 0;
+            }
+            else if(argument.constant)
+            {
+                const int index = static_cast<int>(std::round(argument.value));
+                node.evaluate = [window, index]() { return window->at(index); };
+            }
+            else
+                node.evaluate = [window, a = std::move(argument.evaluate)]() {
+                    return window->at(static_cast<int>(std::round(a())));
+                };
+
+            return node;
+        }
+
+        const std::string &body;
+        const double *n;
+        const termWindow_c *window;
+        size_t position = 0;
+        bool failed = false;
+    };
+
+    expression_t compileExpression(const std::string &body, const double *n, const termWindow_c *window) {
+        return expressionCompiler_c(body, n, window).compile();
+    }
+
+    bool isAffineExpression(const std::string &body)
+    {
+        // nothing is evaluated, so neither the index nor the window have to hold anything
+        const double n = 0.0;
+        expressionCompiler_c compiler(body, &n, nullptr);
+        return compiler.compile() && compiler.affine;
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef SEQUENCER_EXPRESSION_H
+#define SEQUENCER_EXPRESSION_H
+
+#include <functional>
+#include <string>
+
+namespace sequencer_n
+{
+    class termWindow_c;
+
+    using expression_t = std::function<double()>;
+
+    // compiles the body of a rule into a tree of closures that read the index n and look up preceding terms in the
+    // window directly; returns an empty expression if the body uses syntax that is only understood by muparser
+    expression_t compileExpression(const std::string &body, const double *n, const termWindow_c *window);
+
+    // whether the body is built from constants and preceding terms s(n-k) by sums, differences, products with a
+    // constant factor and quotients by a constant divisor only; conditionals, comparisons, n outside of s and
+    // functions of anything but constants make it nonaffine, as does syntax the compiled backend does not understand
+    bool isAffineExpression(const std::string &body);
+}
+
+#endif //SEQUENCER_EXPRESSION_H
@@ -1,325 +1,1144 @@
 #include <algorithm>
+#include <exception>
 #include <functional>
-#include <regex>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <Eigen/Dense>
 #include <muParser.h>
 #include "sequencer/generator.h"
 #include "sequencer/types.h"
+#include "expression.h"
+#include "window.h"
 
 namespace sequencer_n
 {
     constexpr size_t UNSPECIFIED_GAP = static_cast<size_t>(-1);
     constexpr size_t ANY_OFFSET = static_cast<size_t>(-1);
+    constexpr size_t BULK_SIZE = 4096;
 
-    class map_c
+    // jumping ahead pays off once the number of skipped terms exceeds this distance
+    constexpr size_t JUMP_DISTANCE = 1024;
+    constexpr size_t MAXIMUM_JUMP_ORDER = 64;
+    constexpr size_t DEFAULT_RULE_CACHE_CAPACITY = 64;
+
+    enum class ruleType_t
     {
-    public:
-        static inline double s(const double index)
-        {
-            const int _index = static_cast<int>(round(index));
-            auto find = constants.find(_index);
-            return find != constants.end() ? find->second : DBL_MAX;
-        }
+        UNSPECIFIED,
+        CONSTANT,
+        GENERIC
+    };
 
-        static std::map<size_t, double> constants;
+    // reference s(argument) within the body of a rule; arguments of the form a*n+b are resolved by the lexer,
+    // where offset is the index referenced at n = 0 and slope is how far the index advances with n
+    struct reference_t
+    {
+        bool dependsOnN = false;
+        int32_t offset = 0;
+        int32_t slope = 0;
     };
 
-    std::map<size_t, double> map_c::constants;
+    // structured form of a rule line s(k) = body or s(gap*n+offset) = body
+    struct rule_t
+    {
+        ruleType_t type = ruleType_t::UNSPECIFIED;
+        size_t index = 0;
+        size_t gap = 1;
+        size_t offset = ANY_OFFSET;
+        std::string body;
+        std::vector<reference_t> references;
+    };
 
-    sequence_t generate(const std::vector<std::string> &description, const generatorContext_t &context)
+    inline bool isSpace(const char c) {
+        return std::isspace(static_cast<unsigned char>(c));
+    }
+
+    inline bool isDigit(const char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    inline bool isWordCharacter(const char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    std::string stripWhiteSpace(const std::string_view &string)
     {
-        using namespace std;
+        std::string stripped;
+        stripped.reserve(string.size());
+        for(const char c : string)
+            if(!isSpace(c))
+                stripped.push_back(c);
+        return stripped;
+    }
 
-        static regex rulePattern(R"(^\s*s\(([^\)]+)\)\s*=\s*(.+)$)", regex_constants::optimize);
-        static regex explicitRulePattern(R"(^\s*(s\(n\)\s*=\s*)?((?!s\().+)$)", regex_constants::optimize);
-        static regex genericIndexPattern(R"(^(?:\+?(\d+)\s*\*?\s*)?n(?:\+(\d+))?$)", regex_constants::optimize);
-        static regex indexPattern(R"(^[\s0]*(\d+)$)", regex_constants::optimize);
+    // parses an unsigned decimal number at the given position and advances the position behind it
+    bool parseNumber(const std::string_view &string, size_t &position, int64_t &number)
+    {
+        const size_t begin = position;
+        number = 0;
 
-        sequence_t sequence {};
-        auto &constants = map_c::constants;
-        size_t numElements = 0;
-        const size_t endIndex = context.startIndex + context.sequenceLength;
+        for(; position < string.size() && isDigit(string[position]); position++)
+        {
+            number = number * 10 + (string[position] - '0');
+            if(number > std::numeric_limits<int32_t>::max())
+                return false;
+        }
 
-        if(description.empty() || context.sequenceLength == 0)
-            return sequence;
+        return position > begin;
+    }
 
-        constants.clear();
+    // parses an argument that is a sum of integers and integer multiples of n, such as n-1, 2*n+1 or 3
+    bool parseLinearArgument(const std::string_view &argument, int32_t &offset, int32_t &slope)
+    {
+        int64_t constantSum = 0;
+        int64_t slopeSum = 0;
+        size_t position = 0;
 
-        auto isWhiteSpace = [](unsigned char x) {
-            return std::isspace(x);
-        };
+        while(position < argument.size())
+        {
+            int64_t sign = 1;
+            if(argument[position] == '+' || argument[position] == '-')
+                sign = argument[position++] == '-' ? -1 : 1;
+            else if(position > 0)
+                return false;
 
-        /* auto s = [&constants](const double index) {
-            const int _index = static_cast<int>(round(index));
-            auto find = constants.find(_index);
-            return find != constants.end() ? find->second : DBL_MAX;
-        }; */
+            int64_t factor = 1;
+            const bool hasFactor = position < argument.size() && isDigit(argument[position]);
+            if(hasFactor && !parseNumber(argument, position, factor))
+                return false;
 
-        auto mod = [](double number, double divisor) -> double {
-            return fmod(number, divisor);
-        };
+            const bool multiplied = position < argument.size() && argument[position] == '*';
+            if(multiplied)
+                position++;
 
-        mu::Parser parser;
+            if(position < argument.size() && argument[position] == 'n')
+            {
+                position++;
 
-        double n = 0;
-        parser.DefineVar("n", &n);
-        parser.DefineFun("s", map_c::s);
-        parser.DefineFun("mod", mod);
+                int64_t trailingFactor = 1;
+                if(!hasFactor && position < argument.size() && argument[position] == '*')
+                {
+                    position++;
+                    if(!parseNumber(argument, position, trailingFactor))
+                        return false;
+                }
 
-        smatch matches;
-        const string &firstLine = description[0];
+                slopeSum += sign * factor * trailingFactor;
+            }
+            else if(hasFactor && !multiplied)
+                constantSum += sign * factor;
+            else
+                return false;
+        }
 
-        if(description.size() == 1 && regex_search(firstLine, matches, explicitRulePattern))
+        if(argument.empty() || std::abs(constantSum) > std::numeric_limits<int32_t>::max() ||
+            std::abs(slopeSum) > std::numeric_limits<int32_t>::max())
+            return false;
+
+        offset = static_cast<int32_t>(constantSum);
+        slope = static_cast<int32_t>(slopeSum);
+        return true;
+    }
+
+    // collects the s(...) references within a whitespace stripped body
+    void parseReferences(const std::string &body, std::vector<reference_t> &references)
+    {
+        std::unique_ptr<mu::Parser> argumentParser;
+        double n = 0.0;
+
+        for(size_t position = body.find("s("); position != std::string::npos; position = body.find("s(", position + 1))
         {
-            string body = matches[2].str();
-            string bodyStripped = body;
-            bodyStripped.erase(remove_if(bodyStripped.begin(), bodyStripped.end(), isWhiteSpace), bodyStripped.end());
+            if(position > 0 && isWordCharacter(body[position - 1]))
+                continue;
+
+            const size_t begin = position + 2;
+            const size_t end = body.find(')', begin);
+            if(end == std::string::npos)
+                break;
 
-            parser.SetExpr(bodyStripped.c_str());
+            const std::string_view argument(body.data() + begin, end - begin);
 
-            for(size_t index = context.startIndex; index < endIndex; index++)
+            reference_t reference;
+            reference.dependsOnN = argument.find('n') != std::string_view::npos;
+
+            // arguments that are not linear in n are evaluated at n = 0 and n = 1 by muparser
+            if(!parseLinearArgument(argument, reference.offset, reference.slope))
             {
-                n = static_cast<double>(index);
-                double term = parser.Eval();
-                sequence.push_back(term);
+                if(!argumentParser)
+                {
+                    argumentParser = std::make_unique<mu::Parser>();
+                    argumentParser->DefineVar("n", &n);
+                }
+
+                argumentParser->SetExpr(std::string(argument));
+
+                n = 0.0;
+                const double value = argumentParser->Eval();
+                reference.offset = static_cast<int32_t>(reference.dependsOnN ? value : std::round(value));
+
+                n = 1.0;
+                reference.slope = static_cast<int32_t>(argumentParser->Eval()) - reference.offset;
             }
+
+            references.push_back(reference);
+        }
+    }
+
+    // parses a rule line of the form s(param) = body, where param is either an index or gap*n+offset; lines
+    // that do not match this form or whose param is neither are skipped
+    bool parseRule(const std::string &line, rule_t &rule)
+    {
+        size_t position = 0;
+        while(position < line.size() && isSpace(line[position]))
+            position++;
+
+        if(line.compare(position, 2, "s(") != 0)
+            return false;
+
+        const size_t paramBegin = position + 2;
+        const size_t paramEnd = line.find(')', paramBegin);
+        if(paramEnd == std::string::npos || paramEnd == paramBegin)
+            return false;
+
+        position = paramEnd + 1;
+        while(position < line.size() && isSpace(line[position]))
+            position++;
+
+        if(position + 1 >= line.size() || line[position] != '=')
+            return false;
+
+        const std::string param = stripWhiteSpace(std::string_view(line).substr(paramBegin, paramEnd - paramBegin));
+        size_t paramPosition = 0;
+        int64_t number = 0;
+
+        // s(k): the term at index k
+        if(!param.empty() && std::all_of(param.begin(), param.end(), isDigit))
+        {
+            rule.type = ruleType_t::CONSTANT;
+            rule.index = std::stoi(param);
         }
+
+        // s(gap*n+offset): all terms at indexes whose remainder by gap equals offset
         else
         {
-            map<size_t, string> patterns;
-            string anyPattern = "";
-            size_t specifiedGap = UNSPECIFIED_GAP;
+            if(paramPosition < param.size() && (param[paramPosition] == '+' || isDigit(param[paramPosition])))
+            {
+                if(param[paramPosition] == '+')
+                    paramPosition++;
+                if(!parseNumber(param, paramPosition, number))
+                    return false;
+                if(paramPosition < param.size() && param[paramPosition] == '*')
+                    paramPosition++;
+                rule.gap = static_cast<size_t>(number);
+            }
+
+            if(paramPosition >= param.size() || param[paramPosition++] != 'n')
+                return false;
+
+            if(paramPosition < param.size())
+            {
+                if(param[paramPosition++] != '+' || !parseNumber(param, paramPosition, number) || paramPosition != param.size())
+                    return false;
+                rule.offset = static_cast<size_t>(number);
+            }
+
+            rule.type = ruleType_t::GENERIC;
+        }
+
+        rule.body = stripWhiteSpace(std::string_view(line).substr(position + 1));
+        parseReferences(rule.body, rule.references);
+        return true;
+    }
 
+    // parses a single line rule of the form [s(n) =] body whose body does not start with a reference to s
+    bool parseExplicitRule(const std::string &line, std::string &body)
+    {
+        size_t position = 0;
+        while(position < line.size() && isSpace(line[position]))
+            position++;
+
+        if(line.compare(position, 4, "s(n)") == 0)
+        {
+            size_t bodyPosition = position + 4;
+            while(bodyPosition < line.size() && isSpace(line[bodyPosition]))
+                bodyPosition++;
+
+            if(bodyPosition < line.size() && line[bodyPosition] == '=')
+            {
+                bodyPosition++;
+                while(bodyPosition < line.size() && isSpace(line[bodyPosition]))
+                    bodyPosition++;
+
+                if(bodyPosition < line.size() && line.compare(bodyPosition, 2, "s(") != 0)
+                {
+                    body = stripWhiteSpace(std::string_view(line).substr(bodyPosition));
+                    return true;
+                }
+            }
+        }
+
+        if(position >= line.size() || line.compare(position, 2, "s(") == 0)
+            return false;
+
+        body = stripWhiteSpace(std::string_view(line).substr(position));
+        return true;
+    }
+
+    enum class ruleSetType_t
+    {
+        UNSPECIFIED,
+        EXPLICIT,
+        GENERIC,
+        CONSTANTS
+    };
+
+    constexpr size_t NO_RULE = static_cast<size_t>(-1);
+
+    // outcome of parsing and validating a set of rules, which is immutable and shared between generators
+    struct ruleSet_t
+    {
+        ruleSetType_t type = ruleSetType_t::UNSPECIFIED;
+        std::string explicitBody;
+        std::map<size_t, double> constants;
+        std::set<size_t> pinnedIndices;
+
+        // bodies of the generic rules and per offset the index of the body that applies to index % gap
+        std::vector<std::string> bodies;
+        std::vector<size_t> program;
+        size_t gap = UNSPECIFIED_GAP;
+        size_t lookback = 0;
+    };
+
+    // thread-safe least recently used cache of rule sets keyed by their normalized description
+    class ruleCache_c
+    {
+    public:
+        static ruleCache_c &instance()
+        {
+            static ruleCache_c cache;
+            return cache;
+        }
+
+        static std::string normalize(const std::vector<std::string> &description)
+        {
+            std::string key;
             for(const auto &line : description)
             {
-                if(regex_search(line, matches, rulePattern))
+                const size_t first = line.find_first_not_of(" \t\n\v\f\r");
+                const size_t last = line.find_last_not_of(" \t\n\v\f\r");
+                if(first != std::string::npos)
+                    key.append(line, first, last - first + 1);
+                key.push_back('\n');
+            }
+            return key;
+        }
+
+        std::shared_ptr<const ruleSet_t> find(const std::string &key)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto find = index.find(key);
+            if(find == index.end())
+            {
+                misses++;
+                return nullptr;
+            }
+
+            hits++;
+            entries.splice(entries.begin(), entries, find->second);
+            return find->second->second;
+        }
+
+        void insert(const std::string &key, std::shared_ptr<const ruleSet_t> ruleSet)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if(capacity == 0 || index.count(key))
+                return;
+
+            entries.emplace_front(key, std::move(ruleSet));
+            index.insert({ key, entries.begin() });
+            evict();
+        }
+
+        void setCapacity(const size_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->capacity = capacity;
+            evict();
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.clear();
+            index.clear();
+            hits = 0;
+            misses = 0;
+        }
+
+        ruleCacheStatistics_t statistics()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ruleCacheStatistics_t { hits, misses, entries.size(), capacity };
+        }
+
+    private:
+        void evict()
+        {
+            while(entries.size() > capacity)
+            {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+        }
+
+        std::mutex mutex;
+        std::list<std::pair<std::string, std::shared_ptr<const ruleSet_t>>> entries;
+        std::unordered_map<std::string, decltype(entries)::iterator> index;
+        size_t capacity = DEFAULT_RULE_CACHE_CAPACITY;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    // compiles a set of sequence rules once and generates their terms one after another
+    class generator_c
+    {
+    public:
+        generator_c() : parser(createParser()) {}
+
+        generator_c(const generator_c&) = delete;
+        generator_c &operator=(const generator_c&) = delete;
+
+        bool compile(const std::vector<std::string> &description);
+        void load(std::shared_ptr<const ruleSet_t> ruleSet);
+        void seek(const size_t startIndex);
+        bool next(double &term);
+        void nextBulk(double *terms, const size_t count);
+        double evaluate(const size_t index);
+
+        std::shared_ptr<const ruleSet_t> rules;
+        ruleSetType_t type = ruleSetType_t::UNSPECIFIED;
+        expressionBackend_t backend = expressionBackend_t::MUPARSER;
+        termWindow_c window;
+
+    private:
+        std::shared_ptr<ruleSet_t> parse(const std::vector<std::string> &description);
+        expression_t createRule(const std::string &body);
+
+        static double mod(double number, double divisor) {
+            return fmod(number, divisor);
+        }
+
+        // creates a parser that is bound to the variable n and the functions s and mod; in bulk mode muparser
+        // reads the variable as an array that holds one index per evaluated term
+        std::unique_ptr<mu::Parser> createParser(double *variable = nullptr)
+        {
+            auto parser = std::make_unique<mu::Parser>();
+            parser->DefineVar("n", variable != nullptr ? variable : &n);
+            // s must not be folded at compile time, since the terms it refers to are generated later on
+            parser->DefineFunUserData("s", termWindow_c::s, &window, false);
+            parser->DefineFun("mod", mod);
+            return parser;
+        }
+
+        double n = 0;
+        std::unique_ptr<mu::Parser> parser;
+
+        // explicit rules do not depend on preceding terms and are evaluated in bulk over chunks of indexes
+        std::string explicitBody;
+        expression_t explicitRule;
+        std::unique_ptr<mu::Parser> bulkParser;
+        std::vector<double> bulkIndexes;
+
+        // program[offset] holds the compiled rule for index % gap
+        std::vector<std::unique_ptr<mu::Parser>> compiledRules;
+        std::vector<expression_t> program;
+        size_t gap = UNSPECIFIED_GAP;
+        size_t lookback = 0;
+        size_t lastConstantIndex = 0;
+        size_t index = 0;
+
+        // generic rules that are affine in the preceding terms, i.e. s(n) = c0 + c1 s(n-1) + ... + ck s(n-k) with
+        // coefficients that may differ per offset but not per index, advance the state vector [s(n-1), ..., s(n-k), 1]
+        // by a companion matrix, which allows jumping ahead by matrix exponentiation
+        bool analyzeLinearity();
+        void jump(const size_t startIndex);
+
+        bool linearityAnalyzed = false;
+        std::vector<Eigen::MatrixXd> companionMatrices;
+    };
+
+    bool generator_c::compile(const std::vector<std::string> &description)
+    {
+        auto &cache = ruleCache_c::instance();
+        const std::string key = ruleCache_c::normalize(description);
+
+        // a rule set that was compiled before skips parsing and validation entirely
+        auto ruleSet = cache.find(key);
+        if(!ruleSet)
+        {
+            ruleSet = parse(description);
+            if(!ruleSet)
+                return false;
+
+            cache.insert(key, ruleSet);
+        }
+
+        load(ruleSet);
+        return true;
+    }
+
+    void generator_c::load(std::shared_ptr<const ruleSet_t> ruleSet)
+    {
+        rules = std::move(ruleSet);
+        type = rules->type;
+        explicitBody = rules->explicitBody;
+        gap = rules->gap;
+        lookback = rules->lookback;
+        lastConstantIndex = rules->constants.empty() ? 0 : rules->constants.rbegin()->first;
+
+        window.constants = rules->constants;
+        window.pinnedIndices = rules->pinnedIndices;
+
+        if(type == ruleSetType_t::EXPLICIT)
+        {
+            parser->SetExpr(explicitBody);
+            explicitRule = createRule(explicitBody);
+        }
+
+        // compile every generic rule once so that generating a term does no string or parser work
+        compiledRules.clear();
+        std::vector<expression_t> bodies;
+        for(const auto &body : rules->bodies)
+            bodies.push_back(createRule(body));
+
+        program.clear();
+        for(const size_t rule : rules->program)
+            program.push_back(rule != NO_RULE ? bodies[rule] : expression_t {});
+    }
+
+    expression_t generator_c::createRule(const std::string &body)
+    {
+        if(backend == expressionBackend_t::COMPILED)
+        {
+            expression_t rule = compileExpression(body, &n, &window);
+            if(rule)
+                return rule;
+        }
+
+        // the muparser backend is also the fallback for rules that the compiled backend does not understand
+        if(type == ruleSetType_t::EXPLICIT)
+            return [parser = parser.get()]() { return parser->Eval(); };
+
+        compiledRules.push_back(createParser());
+        compiledRules.back()->SetExpr(body);
+        return [parser = compiledRules.back().get()]() { return parser->Eval(); };
+    }
+
+    std::shared_ptr<ruleSet_t> generator_c::parse(const std::vector<std::string> &description)
+    {
+        using namespace std;
+
+        auto ruleSet = make_shared<ruleSet_t>();
+        auto &constants = window.constants;
+        size_t numElements = 0;
+
+        if(description.empty())
+            return nullptr;
+
+        const string &firstLine = description[0];
+
+        if(description.size() == 1 && parseExplicitRule(firstLine, ruleSet->explicitBody))
+        {
+            ruleSet->type = ruleSetType_t::EXPLICIT;
+            return ruleSet;
+        }
+
+        vector<rule_t> rules(description.size());
+        map<size_t, const rule_t*> patterns;
+        const rule_t *anyPattern = nullptr;
+        size_t specifiedGap = UNSPECIFIED_GAP;
+
+        for(size_t i = 0; i < description.size(); i++)
+        {
+            rule_t &rule = rules[i];
+            if(!parseRule(description[i], rule))
+                continue;
+
+            if(rule.type == ruleType_t::CONSTANT)
+            {
+                auto find = constants.find(rule.index);
+                if(find != constants.end())
                 {
-                    string param = matches[1].str();
-                    string paramStripped = param;
-                    paramStripped.erase(remove_if(paramStripped.begin(), paramStripped.end(), isWhiteSpace), paramStripped.end());
+                    cerr << "\033[31mError: term at index " << rule.index << " already defined "
+                        "earlier and cannot be overwritten\033[0m" << endl;
+                    return nullptr;
+                }
 
-                    string body = matches[2].str();
-                    string bodyStripped = body;
-                    bodyStripped.erase(remove_if(bodyStripped.begin(), bodyStripped.end(), isWhiteSpace), bodyStripped.end());
+                n = numElements;
+                parser->SetExpr(rule.body);
+                double term = parser->Eval();
 
-                    smatch indexMatch;
-                    if(regex_search(paramStripped, indexMatch, indexPattern))
-                    {
-                        size_t index = std::stoi(indexMatch[1].str());
-                        auto find = constants.find(index);
-                        if(find != constants.end())
-                        {
-                            cerr << "\033[31mError: term at index " << index << " already defined "
-                                "earlier and cannot be overwritten\033[0m" << endl;
-                            return {};
-                        }
-
-                        n = numElements;
-                        parser.SetExpr(bodyStripped.c_str());
-                        double term = parser.Eval();
-
-                        constants.insert({ index, term });
-                        numElements++;
-                    }
-                    else if(regex_search(paramStripped, indexMatch, genericIndexPattern))
+                constants.insert({ rule.index, term });
+                numElements++;
+            }
+            else if(rule.type == ruleType_t::GENERIC)
+            {
+                if(specifiedGap != UNSPECIFIED_GAP && specifiedGap != rule.gap)
+                {
+                    cerr << "\033[31mError: pattern gap size previously set to " << specifiedGap <<
+                        " and cannot be variable within a sequence/set of rules\033[0m" << endl;
+                    return nullptr;
+                }
+
+                if(rule.offset == ANY_OFFSET)
+                    anyPattern = &rule;
+                else
+                {
+                    auto find = patterns.find(rule.offset);
+                    if(find != patterns.end())
                     {
-                        size_t gap = indexMatch[1].matched ? std::stoi(indexMatch[1].str()) : 1;
-                        size_t offset = indexMatch[2].matched ? std::stoi(indexMatch[2].str()) : ANY_OFFSET;
-
-                        if(specifiedGap != UNSPECIFIED_GAP && specifiedGap != gap)
-                        {
-                            cerr << "\033[31mError: pattern gap size previously set to " << specifiedGap << 
-                                " and cannot be variable within a sequence/set of rules\033[0m" << endl;
-                            return {};
-                        }
-
-                        if(offset == ANY_OFFSET)
-                            anyPattern = bodyStripped;
-                        else
-                        {
-                            auto find = patterns.find(offset);
-                            if(find != patterns.end())
-                            {
-                                cerr << "\033[31mError: pattern offset " << offset << " already defined "
-                                    "earlier and cannot be overwritten\033[0m" << endl;
-                                return {};
-                            }
-
-                            patterns.insert({ offset, bodyStripped });
-                        }
-                        
-                        specifiedGap = gap;
+                        cerr << "\033[31mError: pattern offset " << rule.offset << " already defined "
+                            "earlier and cannot be overwritten\033[0m" << endl;
+                        return nullptr;
                     }
+
+                    patterns.insert({ rule.offset, &rule });
                 }
+
+                specifiedGap = rule.gap;
             }
+        }
 
-            int32_t minOffset = numeric_limits<int32_t>::max();
-            int32_t maxOffset = numeric_limits<int32_t>::min();
-            int32_t offsetSign = 0;
-            set<int32_t> indexOffsets;
+        int32_t minOffset = numeric_limits<int32_t>::max();
+        int32_t maxOffset = numeric_limits<int32_t>::min();
+        int32_t offsetSign = 0;
+        set<int32_t> indexOffsets;
+        bool boundedLookback = true;
 
-            // check if a given pattern is valid with respect to the constants it references
-            auto checkPattern = [&minOffset, &maxOffset, &offsetSign, &indexOffsets](const string &pattern)
+        // check if a given pattern is valid with respect to the constants it references
+        auto checkPattern = [&minOffset, &maxOffset, &offsetSign, &indexOffsets, &boundedLookback, this](const rule_t *pattern)
+        {
+            if(pattern == nullptr || pattern->body.empty())
+                return false;
+
+            for(const auto &reference : pattern->references)
             {
-                if(pattern.empty())
-                    return false;
-                
-                static regex sArgExprPattern(R"((?:[^\w]|^)s\(([^\)]*)\))", regex_constants::optimize);
-                
-                mu::Parser sArgExprParser;
-                double n = 0.0;
-                sArgExprParser.DefineVar("n", &n);
-
-                for(sregex_iterator i = sregex_iterator(pattern.begin(), pattern.end(), sArgExprPattern); 
-                    i != sregex_iterator(); i++ )
+                // if the s function argument depends on n
+                if(reference.dependsOnN)
                 {
-                    smatch matches = *i;
-                    if(!matches[1].matched)
-                        continue;
+                    const int32_t indexOffset = reference.offset;
+                    const int32_t sign = indexOffset < 0 ? -1 : 1;
 
-                    string sArgExpr = matches[1].str();
+                    // the lookback is only bounded by the offset if the argument advances with n
+                    boundedLookback &= reference.slope == 1;
 
-                    // if the s function argument depends on n
-                    if(sArgExpr.find("n") != string::npos)
+                    if(indexOffset < minOffset)
+                        minOffset = indexOffset;
+                    if(indexOffset > maxOffset)
+                        maxOffset = indexOffset;
+
+                    if(offsetSign == 0)
+                        offsetSign = sign;
+                    else if(offsetSign != sign)
                     {
-                        sArgExprParser.SetExpr(sArgExpr);
-
-                        // evaluate the offset to n
-                        const int32_t indexOffset = static_cast<int32_t>(sArgExprParser.Eval());
-                        const int32_t sign = indexOffset < 0 ? -1 : 1;
-
-                        if(indexOffset < minOffset)
-                            minOffset = indexOffset;
-                        if(indexOffset > maxOffset)
-                            maxOffset = indexOffset;
-
-                        if(offsetSign == 0)
-                            offsetSign = sign;
-                        else if(offsetSign != sign)
-                        {
-                            cerr << "\033[31mError: cannot generate sequence: set of rules not allowed to "
-                                "depend on preceding and subsequent terms at the same time!\033[0m" << endl;
-                            return false;
-                        }
-
-                        indexOffsets.insert(indexOffset);
+                        cerr << "\033[31mError: cannot generate sequence: set of rules not allowed to "
+                            "depend on preceding and subsequent terms at the same time!\033[0m" << endl;
+                        return false;
                     }
+
+                    indexOffsets.insert(indexOffset);
                 }
 
-                return true;
-            };
+                // the argument is a fixed index whose term needs to outlive the window
+                else if(reference.offset >= 0)
+                    window.pinnedIndices.insert(reference.offset);
+            }
+
+            return true;
+        };
 
-            if(!checkPattern(anyPattern))
-                return {};
-            
-            for(const auto &[index, pattern] : patterns)
-                if(!checkPattern(pattern))
-                    return {};
+        if(!checkPattern(anyPattern))
+            return nullptr;
 
-            const auto numIndexOffsets = indexOffsets.size();
-            const auto numConstants = constants.size();
+        for(const auto &[index, pattern] : patterns)
+            if(!checkPattern(pattern))
+                return nullptr;
 
-            if(numIndexOffsets > numConstants)
+        const auto numIndexOffsets = indexOffsets.size();
+        const auto numConstants = constants.size();
+
+        if(numIndexOffsets > numConstants)
+        {
+            cerr << "\033[31mError: cannot generate sequence: rules give " << numConstants <<
+                " constant " << (numConstants == 1 ? "term" : "terms") << " but generic rules "
+                "reference " << numIndexOffsets << "\033[0m" << endl;
+            return nullptr;
+        }
+
+        ruleSet->constants = constants;
+        ruleSet->pinnedIndices = window.pinnedIndices;
+
+        // sequence rules are generic (i.e. some contain an s(..) that depends on n)
+        if(specifiedGap != UNSPECIFIED_GAP)
+        {
+            size_t anyRule = NO_RULE;
+
+            if(anyPattern != nullptr)
             {
-                cerr << "\033[31mError: cannot generate sequence: rules give " << numConstants << 
-                    " constant " << (numConstants == 1 ? "term" : "terms") << " but generic rules "
-                    "reference " << numIndexOffsets << "\033[0m" << endl;
-                return {};
+                anyRule = ruleSet->bodies.size();
+                ruleSet->bodies.push_back(anyPattern->body);
             }
 
-            // sequence rules are generic (i.e. some contain an s(..) that depends on n)
-            if(specifiedGap != UNSPECIFIED_GAP)
+            ruleSet->program.assign(specifiedGap, anyRule);
+            for(const auto &[offset, pattern] : patterns)
             {
-                int32_t startIndex = context.startIndex;
-
-                /* if(!constants.empty())
+                if(offset < specifiedGap)
                 {
-                    const auto firstIndex = constants.begin()->first;
-                    const auto lastIndex = constants.rbegin()->first;
-                    const bool consecutiveIndexes = 1 + lastIndex - firstIndex == constants.size();
-
-                    if(consecutiveIndexes)
-                        startIndex = lastIndex + 1;
+                    ruleSet->program[offset] = ruleSet->bodies.size();
+                    ruleSet->bodies.push_back(pattern->body);
                 }
-                else if(!indexOffsets.empty())
-                {
-                    const auto minOffset = *indexOffsets.begin();
-                    startIndex = context.startIndex + minOffset;
-                } */
+            }
 
-                for(size_t index = startIndex; index < endIndex; index++)
-                {
-                    n = static_cast<double>(index);
-                    size_t offset = index % specifiedGap;
-                    double term;
-
-                    auto findConstant = constants.find(index);
-                    if(findConstant != constants.end())
-                        term = findConstant->second;
-                    else
-                    {
-                        auto findPattern = patterns.find(offset);
-                        string pattern = findPattern != patterns.end() ? findPattern->second : anyPattern;
+            // only as many preceding terms as the rules look back are kept while generating
+            ruleSet->gap = specifiedGap;
+            ruleSet->lookback = !boundedLookback ? UNBOUNDED_LOOKBACK : indexOffsets.empty() ? 0 :
+                static_cast<size_t>(max(abs(minOffset), abs(maxOffset)));
+            ruleSet->type = ruleSetType_t::GENERIC;
+            return ruleSet;
+        }
 
-                        parser.SetExpr(pattern);
-                        term = parser.Eval();
-                    }
+        // sequence rules consist of constants only
+        else if(!constants.empty())
+        {
+            ruleSet->type = ruleSetType_t::CONSTANTS;
+            return ruleSet;
+        }
 
-                    constants.insert({ index, term });
-                    
-                    if(index >= context.startIndex)
-                        sequence.push_back(term);
-                }
+        cerr << "\033[31mError: cannot generate sequence: rules do not provide any constant or "
+            "recurrence pattern\033[0m" << endl;
+        return nullptr;
+    }
+
+    void generator_c::seek(const size_t startIndex)
+    {
+        index = startIndex;
+
+        if(type != ruleSetType_t::GENERIC)
+            return;
+
+        // rules without lookback do not need any preceding terms
+        if(lookback == 0 && window.pinnedIndices.empty())
+        {
+            window.reset(lookback, startIndex);
+            return;
+        }
+
+        // all terms up to the last constant are generated one by one, from there on linear rules can jump ahead
+        const size_t jumpIndex = std::max(lastConstantIndex + 1, lookback);
+        const bool jumpAhead = startIndex > jumpIndex + JUMP_DISTANCE && analyzeLinearity();
+
+        window.reset(lookback, 0);
+        index = 0;
+
+        double term;
+        while(index < (jumpAhead ? jumpIndex : startIndex))
+            next(term);
+
+        if(jumpAhead)
+            jump(startIndex);
+    }
+
+    bool generator_c::analyzeLinearity()
+    {
+        if(linearityAnalyzed)
+            return !companionMatrices.empty();
+
+        linearityAnalyzed = true;
+
+        if(lookback == 0 || lookback > MAXIMUM_JUMP_ORDER || !window.pinnedIndices.empty())
+            return false;
+
+        // the probes below only sample a rule, which a piecewise rule such as s(n-1) < 100 ? 2*s(n-1) : s(n-1) - 50
+        // passes as well, so its structure has to be affine in the first place
+        for(const size_t rule : rules->program)
+            if(rule == NO_RULE || !isAffineExpression(rules->bodies[rule]))
+                return false;
+
+        const size_t order = lookback;
+
+        // evaluates a rule at the given index with the given preceding terms, where previous[k] holds s(index-k-1)
+        auto probeRule = [this, order](const expression_t &rule, const size_t index, const Eigen::VectorXd &previous)
+        {
+            window.reset(order, index - order);
+            for(size_t k = order; k-- > 0;)
+                window.push(previous[k]);
+
+            n = static_cast<double>(index);
+            return rule();
+        };
+
+        auto approximatelyEqual = [](const double a, const double b) {
+            return std::fabs(a - b) <= 1.0e-9 * std::max({ 1.0, std::fabs(a), std::fabs(b) });
+        };
+
+        // the rules are probed beyond the last constant, where only the preceding terms are looked up
+        const size_t probeIndex = (lastConstantIndex + order + gap) / gap * gap;
+        const Eigen::VectorXd zero = Eigen::VectorXd::Zero(order);
+        const Eigen::VectorXd probe = Eigen::VectorXd::LinSpaced(order, 0.75, -1.25 * order);
+
+        std::vector<Eigen::MatrixXd> matrices;
+
+        for(size_t offset = 0; offset < gap; offset++)
+        {
+            const expression_t &rule = program[offset];
+            if(!rule)
+                return false;
+
+            const size_t index = probeIndex + offset;
+            Eigen::MatrixXd matrix = Eigen::MatrixXd::Zero(order + 1, order + 1);
+
+            const double constant = probeRule(rule, index, zero);
+            matrix(0, order) = constant;
+
+            for(size_t k = 0; k < order; k++)
+                matrix(0, k) = probeRule(rule, index, Eigen::VectorXd::Unit(order, k)) - constant;
+
+            // a rule is only affine if it reproduces a probe by its coefficients, regardless of the index
+            const double expected = constant + matrix.row(0).head(order).dot(probe);
+            if(!std::isfinite(expected) || !approximatelyEqual(probeRule(rule, index, probe), expected) ||
+                !approximatelyEqual(probeRule(rule, index + 7 * gap, probe), expected))
+                return false;
+
+            for(size_t k = 1; k < order; k++)
+                matrix(k, k - 1) = 1.0;
+            matrix(order, order) = 1.0;
+
+            matrices.push_back(std::move(matrix));
+        }
+
+        companionMatrices = std::move(matrices);
+        return true;
+    }
+
+    void generator_c::jump(const size_t startIndex)
+    {
+        const size_t order = lookback;
+
+        Eigen::VectorXd state(order + 1);
+        for(size_t k = 0; k < order; k++)
+            state[k] = termWindow_c::s(&window, static_cast<double>(index - k - 1));
+        state[order] = 1.0;
+
+        // advance to the next full cycle of offsets, then by whole cycles and finally to the start index
+        for(; index < startIndex && index % gap != 0; index++)
+            state = companionMatrices[index % gap] * state;
+
+        size_t cycles = (startIndex - index) / gap;
+        if(cycles > 0)
+        {
+            Eigen::MatrixXd cycle = Eigen::MatrixXd::Identity(order + 1, order + 1);
+            for(const auto &matrix : companionMatrices)
+                cycle = matrix * cycle;
+
+            Eigen::MatrixXd power = Eigen::MatrixXd::Identity(order + 1, order + 1);
+            for(size_t exponent = cycles; exponent > 0; exponent >>= 1)
+            {
+                if(exponent & 1)
+                    power = cycle * power;
+                cycle = cycle * cycle;
             }
 
-            // sequence rules consist of constants only
-            else if(!constants.empty())
+            state = power * state;
+            index += cycles * gap;
+        }
+
+        for(; index < startIndex; index++)
+            state = companionMatrices[index % gap] * state;
+
+        window.reset(order, startIndex - order);
+        for(size_t k = order; k-- > 0;)
+            window.push(state[k]);
+    }
+
+    double generator_c::evaluate(const size_t index)
+    {
+        double term = DBL_MAX;
+
+        if(type == ruleSetType_t::EXPLICIT)
+        {
+            n = static_cast<double>(index);
+            return explicitRule();
+        }
+
+        seek(index);
+        next(term);
+        return term;
+    }
+
+    bool generator_c::next(double &term)
+    {
+        n = static_cast<double>(index);
+
+        switch(type)
+        {
+            case ruleSetType_t::EXPLICIT:
+                term = explicitRule();
+                break;
+
+            case ruleSetType_t::GENERIC:
             {
-                const auto firstIndex = constants.begin()->first;
-                const auto lastIndex = constants.rbegin()->first;
-                const bool indexesWithinRange = context.startIndex >= firstIndex && endIndex - 1 <= lastIndex;
+                auto &constants = window.constants;
+                auto findConstant = index <= lastConstantIndex ? constants.find(index) : constants.end();
 
-                if(!indexesWithinRange)
-                {
-                    cerr << "\033[31mError: cannot generate sequence: rules give only constant terms "
-                        "but they do not span the requested index range [" << context.startIndex << 
-                        "; " << endIndex << ")\033[0m" << endl;
-                    return {};
-                }
+                if(findConstant != constants.end())
+                    term = findConstant->second;
+                else
+                    term = program[index % gap]();
 
-                const bool consecutiveIndexes = 1 + lastIndex - firstIndex == constants.size();
-                bool consecutiveIndexesWithinRange = true;
+                window.push(term);
+                break;
+            }
 
-                if(!consecutiveIndexes)
-                {
-                    auto it = constants.begin();
-                    for(; it != constants.end() && it->first != context.startIndex; it++);
-                    
-                    for(size_t index = context.startIndex; consecutiveIndexesWithinRange && index < endIndex && 
-                        it != constants.end(); index++, it++)
-                        consecutiveIndexesWithinRange &= index == it->first;
-                }
+            case ruleSetType_t::CONSTANTS:
+            {
+                auto findConstant = window.constants.find(index);
+                if(findConstant == window.constants.end())
+                    return false;
 
-                if(!consecutiveIndexesWithinRange)
-                {
-                    cerr << "\033[31mError: cannot generate sequence: rules give only constant terms "
-                        "within the requested index range but the indexes are not consecutive\033[0m" << endl;
-                    return {};
-                }
+                term = findConstant->second;
+                break;
+            }
+
+            default:
+                return false;
+        }
 
-                for(const auto [_4, term] : constants)
-                    sequence.push_back(term);
+        index++;
+        return true;
+    }
+
+    void generator_c::nextBulk(double *terms, const size_t count)
+    {
+        if(type != ruleSetType_t::EXPLICIT)
+        {
+            for(size_t i = 0; i < count && next(terms[i]); i++);
+            return;
+        }
+
+        // closures evaluate one index at a time, which is already cheaper than a bulk evaluation by muparser
+        if(backend == expressionBackend_t::COMPILED)
+        {
+            for(size_t i = 0; i < count; i++, index++)
+            {
+                n = static_cast<double>(index);
+                terms[i] = explicitRule();
             }
+            return;
+        }
 
-            else
+        if(!bulkParser)
+        {
+            bulkIndexes.resize(BULK_SIZE);
+            bulkParser = createParser(bulkIndexes.data());
+            bulkParser->SetExpr(explicitBody);
+        }
+
+        for(size_t chunk = 0; chunk < count; chunk += BULK_SIZE)
+        {
+            const size_t chunkSize = std::min(BULK_SIZE, count - chunk);
+            const double firstIndex = static_cast<double>(index + chunk);
+
+            for(size_t i = 0; i < chunkSize; i++)
+                bulkIndexes[i] = firstIndex + static_cast<double>(i);
+
+            bulkParser->Eval(terms + chunk, static_cast<int>(chunkSize));
+        }
+
+        index += count;
+    }
+
+    sequence_t generate(const std::vector<std::string> &description, const generatorContext_t &context)
+    {
+        using namespace std;
+
+        sequence_t sequence {};
+        const size_t endIndex = context.startIndex + context.sequenceLength;
+
+        if(description.empty() || context.sequenceLength == 0)
+            return sequence;
+
+        generator_c generator;
+        generator.backend = context.expressionBackend;
+        if(!generator.compile(description))
+            return {};
+
+        // sequence rules consist of constants only
+        if(generator.type == ruleSetType_t::CONSTANTS)
+        {
+            const auto &constants = generator.window.constants;
+            const auto firstIndex = constants.begin()->first;
+            const auto lastIndex = constants.rbegin()->first;
+            const bool indexesWithinRange = context.startIndex >= firstIndex && endIndex - 1 <= lastIndex;
+
+            if(!indexesWithinRange)
             {
-                cerr << "\033[31mError: cannot generate sequence: rules do not provide any constant or "
-                    "recurrence pattern\033[0m" << endl;
+                cerr << "\033[31mError: cannot generate sequence: rules give only constant terms "
+                    "but they do not span the requested index range [" << context.startIndex <<
+                    "; " << endIndex << ")\033[0m" << endl;
+                return {};
+            }
+
+            const bool consecutiveIndexes = 1 + lastIndex - firstIndex == constants.size();
+            bool consecutiveIndexesWithinRange = true;
+
+            if(!consecutiveIndexes)
+            {
+                auto it = constants.begin();
+                for(; it != constants.end() && it->first != context.startIndex; it++);
+
+                for(size_t index = context.startIndex; consecutiveIndexesWithinRange && index < endIndex &&
+                    it != constants.end(); index++, it++)
+                    consecutiveIndexesWithinRange &= index == it->first;
+            }
+
+            if(!consecutiveIndexesWithinRange)
+            {
+                cerr << "\033[31mError: cannot generate sequence: rules give only constant terms "
+                    "within the requested index range but the indexes are not consecutive\033[0m" << endl;
                 return {};
             }
         }
-        
+
+        generator.seek(context.startIndex);
+
+        if(generator.type == ruleSetType_t::EXPLICIT)
+        {
+            sequence.resize(context.sequenceLength);
+
+            // explicit rules only depend on the index, so each worker evaluates its own slice with its own parser
+            const size_t hardwareThreads = std::max<size_t>(thread::hardware_concurrency(), 1);
+            const size_t workerCount = std::min(context.workerCount == 0 ? hardwareThreads : context.workerCount,
+                (context.sequenceLength + BULK_SIZE - 1) / BULK_SIZE);
+
+            if(workerCount <= 1)
+            {
+                generator.nextBulk(sequence.data(), sequence.size());
+                return sequence;
+            }
+
+            const size_t sliceSize = (context.sequenceLength + workerCount - 1) / workerCount;
+            vector<exception_ptr> exceptions(workerCount);
+            vector<thread> workers;
+
+            for(size_t worker = 1; worker < workerCount; worker++)
+            {
+                workers.emplace_back([&, worker]() {
+                    try
+                    {
+                        const size_t first = std::min(worker * sliceSize, context.sequenceLength);
+                        const size_t count = std::min(sliceSize, context.sequenceLength - first);
+
+                        generator_c sliceGenerator;
+                        sliceGenerator.backend = generator.backend;
+                        sliceGenerator.load(generator.rules);
+                        sliceGenerator.seek(context.startIndex + first);
+                        sliceGenerator.nextBulk(sequence.data() + first, count);
+                    }
+                    catch(...)
+                    {
+                        exceptions[worker] = current_exception();
+                    }
+                });
+            }
+
+            try
+            {
+                generator.nextBulk(sequence.data(), sliceSize);
+            }
+            catch(...)
+            {
+                exceptions[0] = current_exception();
+            }
+
+            for(auto &worker : workers)
+                worker.join();
+
+            for(const auto &exception : exceptions)
+                if(exception)
+                    rethrow_exception(exception);
+
+            return sequence;
+        }
+
+        sequence.reserve(context.sequenceLength);
+
+        double term;
+        for(size_t index = context.startIndex; index < endIndex && generator.next(term); index++)
+            sequence.push_back(term);
+
         return sequence;
     }
+
+    std::optional<double> generateTerm(const std::vector<std::string> &description, const size_t index)
+    {
+        generator_c generator;
+        if(!generator.compile(description))
+            return std::nullopt;
+
+        double term = generator.evaluate(index);
+        if(generator.type == ruleSetType_t::CONSTANTS && !generator.window.constants.count(index))
+            return std::nullopt;
+
+        return term;
+    }
+
+    void setRuleCacheCapacity(const size_t capacity) {
+        ruleCache_c::instance().setCapacity(capacity);
+    }
+
+    void clearRuleCache() {
+        ruleCache_c::instance().clear();
+    }
+
+    ruleCacheStatistics_t ruleCacheStatistics() {
+        return ruleCache_c::instance().statistics();
+    }
+
+    lazySequence_c::lazySequence_c(const std::vector<std::string> &description, const size_t startIndex) :
+        generator(std::make_unique<generator_c>())
+    {
+        if(generator->compile(description))
+        {
+            generator->seek(startIndex);
+            exhausted = false;
+        }
+    }
+
+    lazySequence_c::lazySequence_c(lazySequence_c &&other) noexcept = default;
+    lazySequence_c &lazySequence_c::operator=(lazySequence_c &&other) noexcept = default;
+    lazySequence_c::~lazySequence_c() = default;
+
+    lazySequence_c::iterator_c lazySequence_c::begin()
+    {
+        if(!started)
+        {
+            started = true;
+            advance();
+        }
+
+        return iterator_c(this);
+    }
+
+    void lazySequence_c::advance()
+    {
+        if(!exhausted)
+            exhausted = !generator->next(term);
+    }
 }
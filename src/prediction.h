@@ -0,0 +1,115 @@
+#ifndef SEQUENCER_PREDICTION_H
+#define SEQUENCER_PREDICTION_H
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+#include "sequencer/types.h"
+
+namespace sequencer_n
+{
+    /* kernels that write count predicted terms into output, which has room for them, each from the terms that precede
+     * the first prediction; they keep only as many preceding terms as the form looks back, in the order in which the
+     * terms were calculated before, so that every form yields the same terms as a term by term evaluation */
+
+    template<operation_t operation>
+    inline double applyOperation(const double previous, const double operand)
+    {
+        if constexpr(operation == operation_t::ADDITION)
+            return previous + operand;
+        else
+            return previous * operand;
+    }
+
+    // s(n) = s(n-1) + operand or s(n) = s(n-1) * operand
+    template<operation_t operation>
+    void predictConstantPattern(double previous, const double operand, double *output, const size_t count)
+    {
+        for(size_t n = 0; n < count; n++)
+            output[n] = previous = applyOperation<operation>(previous, operand);
+    }
+
+    // the pattern at offset yields the first prediction, the following patterns the next ones in turn
+    inline void predictPeriodicPattern(double previous, std::span<const pattern_t> patterns, size_t offset, double *output,
+        const size_t count)
+    {
+        for(size_t n = 0; n < count; n++)
+        {
+            const auto &pattern = patterns[offset];
+            previous = pattern.operation == operation_t::ADDITION ?
+                applyOperation<operation_t::ADDITION>(previous, pattern.operand) :
+                applyOperation<operation_t::MULTIPLICATION>(previous, pattern.operand);
+            output[n] = previous;
+
+            if(++offset == patterns.size())
+                offset = 0;
+        }
+    }
+
+    // s(n) = coefficients[0] s(n-order) + ... + coefficients[order-1] s(n-1), over the last terms held in registers
+    template<size_t order>
+    void predictRecurrence(const double *coefficients, const double *last, double *output, const size_t count)
+    {
+        std::array<double, order> window;
+        std::copy(last, last + order, window.begin());
+
+        for(size_t n = 0; n < count; n++)
+        {
+            double number = 0.0;
+            for(size_t i = 0; i < order; i++)
+                number += coefficients[i] * window[i];
+
+            for(size_t i = 0; i + 1 < order; i++)
+                window[i] = window[i + 1];
+            window[order - 1] = number;
+
+            output[n] = number;
+        }
+    }
+
+    // any order: every term is written to a ring buffer of twice the order at two positions one order apart, so that
+    // the last order terms always lie next to each other, oldest first
+    inline void predictRecurrence(std::span<const double> coefficients, const double *last, double *output, const size_t count)
+    {
+        const size_t order = coefficients.size();
+        std::vector<double> ring(2 * order);
+        std::copy(last, last + order, ring.begin());
+        std::copy(last, last + order, ring.begin() + order);
+
+        for(size_t n = 0, position = 0; n < count; n++)
+        {
+            double number = 0.0;
+            for(size_t i = 0; i < order; i++)
+                number += coefficients[i] * ring[position + i];
+
+            ring[position] = ring[position + order] = number;
+            if(++position == order)
+                position = 0;
+
+            output[n] = number;
+        }
+    }
+
+    // a polynomial of the given degree through the last degree + 1 terms: after the last entry of every row of their
+    // difference table is known, every further term takes one addition per row
+    inline void predictPolynomial(const size_t degree, const double *last, double *output, const size_t count)
+    {
+        std::vector<double> row(last, last + degree + 1), diagonal(degree + 1);
+        for(size_t order = 0; order <= degree; order++)
+        {
+            diagonal[order] = row[degree - order];
+            for(size_t i = 0; i + order < degree; i++)
+                row[i] = row[i + 1] - row[i];
+        }
+
+        for(size_t n = 0; n < count; n++)
+        {
+            for(size_t order = degree; order-- > 0;)
+                diagonal[order] += diagonal[order + 1];
+            output[n] = diagonal[0];
+        }
+    }
+}
+
+#endif //SEQUENCER_PREDICTION_H
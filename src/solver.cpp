@@ -1,346 +1,1714 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <numeric>
 #include <set>
 #include <map>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <fmt/core.h>
-#include <Eigen/Eigen>
 
 #include "sequencer/solver.h"
 #include "sequencer/types.h"
 #include "sequencer/utils.h"
+#include "artefacts.h"
+#include "prediction.h"
+#include "store.h"
 
 namespace sequencer_n
 {
-    void calculatePredictions(const sequence_t &sequence, sequence_t &predictions, const size_t predictionCount, 
-        std::function<double(double, size_t)> formula)
+    /* how a detection continues the sequence: patterns that are applied to the preceding term in turn, where the
+     * pattern at (index - 1) % gap yields the term at index, a linear recurrence over the preceding terms, or a
+     * polynomial of the given degree, which is continued through the last entries of its finite difference table */
+    struct continuation_t
     {
-        auto lastNumber = sequence.back();
+        std::vector<pattern_t> patterns;
+        std::vector<double> coefficients;
+        uint32_t degree = 0;
+    };
 
-        // calculate predictionCount new predicted numbers and add them to the result
-        for(size_t i = 0; i < predictionCount; i++)
+    // what a detector found, from which the predicted terms and the description are derived for any number of terms
+    struct detection_t
+    {
+        sequenceType_t sequenceType;
+        continuation_t continuation;
+        // the prediction is dropped if an earlier one already continues the sequence the same way
+        bool deduplicated = false;
+    };
+
+    // the number of terms that the kernel of the continuation starts from
+    size_t lookback(const continuation_t &continuation)
+    {
+        if(continuation.degree != 0)
+            return size_t(continuation.degree) + 1;
+
+        return std::max<size_t>(continuation.coefficients.size(), 1);
+    }
+
+    // sets the predictions to predictionCount terms that continue the sequence, by the kernel of the form of the
+    // continuation
+    void continueSequence(const continuation_t &continuation, std::span<const double> sequence,
+        std::pmr::vector<double> &predictions, const size_t predictionCount)
+    {
+        const auto &coefficients = continuation.coefficients;
+        const auto &patterns = continuation.patterns;
+
+        predictions.resize(predictionCount);
+        if(predictionCount == 0)
+            return;
+
+        const double *last = sequence.data() + sequence.size() - lookback(continuation);
+        double *output = predictions.data();
+
+        if(continuation.degree != 0)
+        {
+            predictPolynomial(continuation.degree, last, output, predictionCount);
+            return;
+        }
+
+        if(coefficients.empty())
+        {
+            if(patterns.size() == 1 && patterns[0].operation == operation_t::ADDITION)
+                predictConstantPattern<operation_t::ADDITION>(last[0], patterns[0].operand, output, predictionCount);
+            else if(patterns.size() == 1)
+                predictConstantPattern<operation_t::MULTIPLICATION>(last[0], patterns[0].operand, output, predictionCount);
+            else
+                predictPeriodicPattern(last[0], patterns, (sequence.size() - 1) % patterns.size(), output, predictionCount);
+            return;
+        }
+
+        // the orders of common recurrences get kernels that keep their terms in registers
+        switch(coefficients.size())
         {
-            const auto newIndex = sequence.size() + predictions.size();   
-            auto number = formula(lastNumber, newIndex);
+        case 1:
+            predictRecurrence<1>(coefficients.data(), last, output, predictionCount);
+            break;
+        case 2:
+            predictRecurrence<2>(coefficients.data(), last, output, predictionCount);
+            break;
+        case 3:
+            predictRecurrence<3>(coefficients.data(), last, output, predictionCount);
+            break;
+        case 4:
+            predictRecurrence<4>(coefficients.data(), last, output, predictionCount);
+            break;
+        default:
+            predictRecurrence(coefficients, last, output, predictionCount);
+            break;
+        }
+    }
+
+    std::string describeRecurrence(std::span<const double> coefficients)
+    {
+        std::stringstream ss;
+        ss << "s(n) =";
+        for(size_t i = 0; i < coefficients.size(); i++)
+        {
+            double coefficient = coefficients[coefficients.size() - i - 1];
+            std::string coeffStr = std::to_string(std::abs(coefficient));
+            coeffStr.erase(coeffStr.find_last_not_of('0') + 1, std::string::npos);
+            coeffStr.erase(coeffStr.find_last_not_of('.') + 1, std::string::npos);
 
-            predictions.push_back(number);
-            lastNumber = number;
+            ss << " ";
+            if(i == 0 && coefficient < 0) ss << "-";
+            else if(i > 0) ss << (coefficient < 0 ? "- " : "+ ");
+            if(!approximatelyEqual(std::abs(coefficient), 1.0, 0.0001))
+                ss << coeffStr;
+            ss << "s(n-" << (i + 1) << ")";
         }
+
+        return ss.str();
     }
 
-    void calculateRecursivePredictions(const sequence_t &sequence, sequence_t &predictions, const size_t predictionCount, 
-        std::function<double(const sequence_t &, size_t)> formula)
+    // the coefficients of the polynomial of the given degree through the first terms, lowest power first
+    std::vector<double> polynomialCoefficients(std::span<const double> sequence, const uint32_t degree)
     {
-        sequence_t combined = sequence;
+        // Newton's forward form: s(n) is the sum of the j-th differences at 0 times n choose j
+        std::vector<double> row(sequence.begin(), sequence.begin() + degree + 1);
+        std::vector<double> coefficients(degree + 1, 0.0);
+        std::vector<double> binomial { 1.0 };
 
-        // calculate predictionCount new predicted numbers and add them to the result
-        for(size_t i = 0; i < predictionCount; i++)
+        for(uint32_t j = 0; j <= degree; j++)
         {
-            const auto newIndex = combined.size();   
-            auto number = formula(combined, newIndex);
+            for(size_t power = 0; power < binomial.size(); power++)
+                coefficients[power] += row[0] * binomial[power];
 
-            combined.push_back(number);
-            predictions.push_back(number);
+            for(size_t i = 0; i + 1 < row.size(); i++)
+                row[i] = row[i + 1] - row[i];
+            row.pop_back();
+
+            // n choose j + 1 is n choose j times (n - j) / (j + 1)
+            binomial.push_back(0.0);
+            for(size_t power = binomial.size() - 1; power > 0; power--)
+                binomial[power] = (binomial[power - 1] - j * binomial[power]) / (j + 1);
+            binomial[0] = -(j * binomial[0]) / (j + 1);
         }
+
+        return coefficients;
     }
 
-    solution_t solve(const sequence_t &sequence, const solverContext_t &context)
+    std::string describePolynomial(const std::vector<double> &coefficients)
     {
-        solution_t result {};
+        double largest = 0.0;
+        for(const double coefficient : coefficients)
+            largest = std::max(largest, std::abs(coefficient));
 
-        if(sequence.size() <= 1)
+        std::string description = "s(n) =";
+        bool first = true;
+
+        for(size_t power = coefficients.size(); power-- > 0;)
+        {
+            // rounding noise of the differences is not written out
+            double coefficient = coefficients[power];
+            if(std::abs(coefficient) <= 1.0e-9 * largest)
+                continue;
+            if(virtuallyInteger(coefficient))
+                coefficient = std::round(coefficient);
+
+            description += first ? (coefficient < 0 ? " -" : " ") : (coefficient < 0 ? " - " : " + ");
+            first = false;
+
+            if(power == 0 || std::abs(coefficient) != 1.0)
+                description += fmt::format("{}", std::abs(coefficient));
+            if(power > 0)
+                description += power == 1 ? "n" : fmt::format("n^{}", power);
+        }
+
+        return first ? description + " 0" : description;
+    }
+
+    std::vector<std::string> describe(const prediction_t &prediction)
+    {
+        std::vector<std::string> descriptionList;
+        const auto &rule = prediction.rule;
+        const auto &patterns = rule.patterns;
+
+        switch(rule.form)
         {
-            if(sequence.size() == 1)
+        case ruleForm_t::NONE:
+            break;
+        case ruleForm_t::RECURRENCE:
+            for(uint32_t i = 0; i < rule.initialTerms.size(); i++)
+                descriptionList.emplace_back(fmt::format("s({}) = {}", i, rule.initialTerms[i]));
+            descriptionList.emplace_back(describeRecurrence(rule.coefficients));
+            break;
+        case ruleForm_t::POLYNOMIAL:
+            descriptionList.emplace_back(describePolynomial(polynomialCoefficients(rule.initialTerms,
+                static_cast<uint32_t>(rule.initialTerms.size() - 1))));
+            break;
+        case ruleForm_t::PATTERNS:
+            if(prediction.sequenceType == sequenceType_t::ARITHMETIC)
             {
-                prediction_t prediction;
-                prediction.sequenceType = sequenceType_t::UNSPECIFIED;
-                for(size_t i = 0; i < context.requiredPredictedContinuationCount; i++)
-                    prediction.predictedContinuation.push_back(sequence[0]);
-                result.predictions.emplace_back(prediction);
+                const auto constant = patterns[0].operand;
+                descriptionList.emplace_back(fmt::format("s(n) = s(n-1) {} {}", constant < 0 ? "-" : "+", std::abs(constant)));
+                break;
             }
-            return result;
+
+            if(prediction.sequenceType == sequenceType_t::GEOMETRIC)
+            {
+                descriptionList.emplace_back(fmt::format("s(n) = {}s(n-1)", patterns[0].operand));
+                break;
+            }
+
+            for(size_t offset = 0; offset < patterns.size(); offset++)
+            {
+                const auto &pattern = patterns[offset];
+
+                std::string description = fmt::format("s({}n+{}) = ", patterns.size(), (offset + 1) % patterns.size());
+                if(pattern.operation == operation_t::MULTIPLICATION)
+                    description += fmt::format("{}", pattern.operand);
+                description += "s(n-1)";
+                if(pattern.operation == operation_t::ADDITION)
+                    description += fmt::format(" {} {}", pattern.operand < 0 ? "-" : "+", std::abs(pattern.operand));
+
+                descriptionList.emplace_back(description);
+            }
+            break;
         }
 
-        struct artefact_t
+        return descriptionList;
+    }
+
+    std::vector<std::string> prediction_t::descriptionList() const {
+        return describe(*this);
+    }
+
+    // the rule that describe() renders, which holds no more of the sequence than the terms the rule starts from
+    void assignRule(const detection_t &detection, std::span<const double> sequence, predictionRule_t &rule)
+    {
+        const auto &continuation = detection.continuation;
+
+        if(continuation.degree != 0)
         {
-            double difference;
-            double ratio;
-        };
+            rule.form = ruleForm_t::POLYNOMIAL;
+            rule.initialTerms.assign(sequence.begin(), sequence.begin() + continuation.degree + 1);
+        }
+        else if(!continuation.coefficients.empty())
+        {
+            rule.form = ruleForm_t::RECURRENCE;
+            rule.coefficients.assign(continuation.coefficients.begin(), continuation.coefficients.end());
+            rule.initialTerms.assign(sequence.begin(), sequence.begin() + continuation.coefficients.size());
+        }
+        else
+        {
+            rule.form = ruleForm_t::PATTERNS;
+            rule.patterns.assign(continuation.patterns.begin(), continuation.patterns.end());
+        }
+    }
 
-        std::vector<artefact_t> artefacts;
+    /* Berlekamp–Massey over the reals: finds the shortest linear recurrence
+     *  s(n) = coefficients[0] s(n-L) + ... + coefficients[L-1] s(n-1)
+     * that generates the sequence, extending it by one term at a time; discrepancies that are negligible compared to
+     * the magnitude of the terms they are computed from count as zero. Each order extends the recurrence of the
+     * previous one, so the search gives up as soon as the order exceeds the maximum and takes O(maximumOrder) per term */
+    class recurrenceFinder_c
+    {
+    public:
+        void reset(const size_t maximumOrder)
+        {
+            this->maximumOrder = maximumOrder;
 
-        double last = sequence[0];
-        double lastDifference = DBL_MAX;
-        double lastRatio = DBL_MAX;
+            // connection polynomials C(x) = 1 + c1 x + ... + cL x^L of the current and the last shorter recurrence,
+            // whose degrees never exceed the order and which thus fit into buffers that are allocated once
+            connection.assign(maximumOrder + 1, 0.0);
+            previousConnection.assign(maximumOrder + 1, 0.0);
+            updated.assign(maximumOrder + 1, 0.0);
+            connection[0] = 1.0;
+            previousConnection[0] = 1.0;
 
-        bool constantDifference = true;
-        bool constantRatio = true;
-        bool containsDecimals = !virtuallyInteger(last);
+            previousDiscrepancy = 1.0;
+            previousLength = 0;
+            length = 0;
+            shift = 1;
+            failed = false;
+        }
 
-        // gather differences and ratios between terms
-        for(size_t i = 1; i < sequence.size(); i++)
+        // takes the term at index n into account, given all terms before it; returns false once no recurrence up
+        // to the maximum order generates the sequence
+        bool push(std::span<const double> sequence, const size_t n)
         {
-            double current = sequence[i];
-            double difference = current - last;
-            double ratio = current / last;
+            if(failed)
+                return false;
+
+            double discrepancy = sequence[n];
+            double magnitude = std::abs(sequence[n]);
+            for(size_t i = 1; i <= length; i++)
+            {
+                discrepancy += connection[i] * sequence[n - i];
+                magnitude += std::abs(connection[i] * sequence[n - i]);
+            }
+
+            if(!std::isfinite(discrepancy))
+            {
+                failed = true;
+                return false;
+            }
+
+            if(std::abs(discrepancy) <= tolerance * magnitude)
+            {
+                shift++;
+                return true;
+            }
 
-            containsDecimals |= !virtuallyInteger(current);
+            const bool lengthens = 2 * length <= n;
+            const size_t nextLength = lengthens ? n + 1 - length : length;
+            if(nextLength > maximumOrder)
+            {
+                failed = true;
+                return false;
+            }
 
-            artefacts.emplace_back(artefact_t { difference, ratio });
+            const double factor = discrepancy / previousDiscrepancy;
+            std::copy(connection.begin(), connection.end(), updated.begin());
+            for(size_t i = 0; i <= previousLength && i + shift <= maximumOrder; i++)
+                updated[i + shift] -= factor * previousConnection[i];
 
-            if(i > 1)
+            if(lengthens)
             {
-                constantDifference &= approximatelyEqual(difference, lastDifference, calculateSuitableEpsilon(difference));
-                constantRatio &= approximatelyEqual(ratio, lastRatio, calculateSuitableEpsilon(ratio));
+                std::swap(previousConnection, connection);
+                previousDiscrepancy = discrepancy;
+                previousLength = length;
+                length = nextLength;
+                shift = 1;
             }
+            else
+                shift++;
 
-            lastDifference = difference;
-            lastRatio = ratio;
-            last = current;
+            std::swap(connection, updated);
+            return true;
         }
 
-        const bool ambiguous = constantDifference && constantRatio;
+        // returns the coefficients of the recurrence found so far, if there is one of at most the given order
+        bool recurrence(const size_t maximumOrder, std::vector<double> &coefficients) const
+        {
+            if(failed || length == 0 || length > maximumOrder)
+                return false;
+
+            coefficients.resize(length);
+            for(size_t i = 0; i < length; i++)
+                coefficients[i] = -connection[length - i];
 
-        if(ambiguous && context.allowMultiplePredictions || constantDifference)
+            return true;
+        }
+
+        // checks whether the recurrence generates the term at index n from its predecessors, with the tolerance of push()
+        static bool generates(const std::vector<double> &coefficients, std::span<const double> sequence, const size_t n)
         {
-            prediction_t prediction {};
-            prediction.sequenceType = sequenceType_t::ARITHMETIC;
+            const size_t order = coefficients.size();
+            if(n < order)
+                return false;
 
-            const auto constant = artefacts[0].difference;
-            calculatePredictions(sequence, prediction.predictedContinuation, context.requiredPredictedContinuationCount, 
-                [constant](double previousNumber, size_t newIndex) -> double {
-                    return previousNumber + constant;
-                });
+            double discrepancy = sequence[n];
+            double magnitude = std::abs(sequence[n]);
+            for(size_t i = 0; i < order; i++)
+            {
+                discrepancy -= coefficients[i] * sequence[n - order + i];
+                magnitude += std::abs(coefficients[i] * sequence[n - order + i]);
+            }
 
-            prediction.descriptionList.emplace_back(fmt::format("s(n) = s(n-1) {} {}", constant < 0 ? "-" : "+", std::abs(constant)));
-            result.predictions.emplace_back(prediction);
-            
-            if(!context.allowMultiplePredictions)
-                return result;
+            return std::isfinite(discrepancy) && std::abs(discrepancy) <= tolerance * magnitude;
         }
-        
-        if(ambiguous && context.allowMultiplePredictions || constantRatio)
+
+        // checks whether the recurrence can be run backwards, i.e. its coefficient of the oldest term is not negligible;
+        // the coefficients found are only accurate to a few digits if the terms vary a lot in magnitude, so a
+        // coefficient that vanishes in exact arithmetic is told apart by a much coarser threshold than discrepancies
+        static bool reversible(const std::vector<double> &coefficients)
         {
-            prediction_t prediction {};
-            prediction.sequenceType = sequenceType_t::GEOMETRIC;
+            constexpr double threshold = 1.0e-4;
 
-            const auto constant = artefacts[0].ratio;
-            calculatePredictions(sequence, prediction.predictedContinuation, context.requiredPredictedContinuationCount, 
-                [constant](double previousNumber, size_t newIndex) -> double {
-                    return previousNumber * constant;
-                });
+            double magnitude = 0.0;
+            for(const double coefficient : coefficients)
+                magnitude += std::abs(coefficient);
 
-            prediction.descriptionList.emplace_back(fmt::format("s(n) = {}s(n-1)", constant));
-            result.predictions.emplace_back(prediction);
-            
-            if(!context.allowMultiplePredictions)
-                return result;
+            return !coefficients.empty() && std::abs(coefficients[0]) > threshold * std::max(magnitude, 1.0);
         }
 
-        std::vector<pattern_t> foundPatterns;
-        uint32_t foundGap = 0;
+    private:
+        static constexpr double tolerance = 1.0e-9;
+
+        std::vector<double> connection;
+        std::vector<double> previousConnection;
+        std::vector<double> updated;
+        double previousDiscrepancy = 1.0;
+        size_t previousLength = 0;
+        size_t length = 0;
+        size_t shift = 1;
+        size_t maximumOrder = 0;
+        bool failed = false;
+    };
+
+    // buffers that one thread reuses for every sequence it solves
+    struct workspace_t
+    {
+        // differences and ratios between neighbouring terms, kept apart so that they are extracted in one sweep
+        std::vector<double> differences;
+        std::vector<double> ratios;
+        // the current row of the finite difference table of the polynomial detector
+        std::vector<double> differenceRow;
+        recurrenceFinder_c recurrenceFinder;
+        std::vector<double> coefficients;
+    };
+
+    struct artefactSymbols_t;
+
+    struct analysis_t
+    {
+        std::span<const double> sequence;
+        // buffers of the thread that runs the detector
+        workspace_t *workspace;
+        std::span<const double> differences;
+        std::span<const double> ratios;
+        bool constantDifference = true;
+        bool constantRatio = true;
+        bool containsDecimals = false;
+        bool ambiguous = false;
 
-        for(uint32_t gap = artefacts.size() - 1; gap > 1; gap--)
+        // set if the periodic gap is kept up to date term by term instead of being searched for by its detector
+        bool periodicGapKnown = false;
+        size_t periodicGap = 0;
+        // the quantized artefacts if they are kept up to date term by term as well
+        const artefactSymbols_t *symbols = nullptr;
+
+        // set if the lowest constant row of the finite difference table is kept up to date term by term; a degree
+        // of 0 means that there is none
+        bool polynomialDegreeKnown = false;
+        size_t polynomialDegree = 0;
+
+        // set if the minimal recurrence is kept up to date term by term; its coefficients are then found in
+        // recurrence if recurrenceFound is set
+        bool recurrenceKnown = false;
+        bool recurrenceFound = false;
+        std::span<const double> recurrence {};
+    };
+
+    // adds the difference and ratio between the term at the given index and its predecessor to the artefacts of the
+    // workspace, which the artefacts of the analysis refer to afterwards
+    void appendArtefact(analysis_t &analysis, const size_t index)
+    {
+        auto &differences = analysis.workspace->differences;
+        auto &ratios = analysis.workspace->ratios;
+        const double current = analysis.sequence[index];
+        const double last = analysis.sequence[index - 1];
+        const double difference = current - last;
+        const double ratio = current / last;
+
+        if(index == 1)
+            analysis.containsDecimals = !virtuallyInteger(last);
+        analysis.containsDecimals |= !virtuallyInteger(current);
+
+        if(!differences.empty())
         {
-            std::vector<pattern_t> patterns;
-            bool equal = true;
+            analysis.constantDifference &= sameArtefact(differences.back(), difference);
+            analysis.constantRatio &= sameArtefact(ratios.back(), ratio);
+        }
 
-            for(size_t offset = gap; offset < artefacts.size() && equal; offset++)
-            {
-                const auto &a = artefacts[offset % gap];
-                const auto &b = artefacts[offset];
-                equal &= a.difference == b.difference || a.ratio == b.ratio;
+        differences.push_back(difference);
+        ratios.push_back(ratio);
+        analysis.differences = differences;
+        analysis.ratios = ratios;
+        analysis.ambiguous = analysis.constantDifference && analysis.constantRatio;
+    }
 
-                if(equal)
-                {
-                    pattern_t pattern;
-                    pattern.gap = gap;
-                    pattern.offset = offset;
-                    pattern.operation = a.difference == b.difference ? operation_t::ADDITION : operation_t::MULTIPLICATION;
-                    pattern.operand = a.difference == b.difference ? a.difference : a.ratio;
-                    patterns.emplace_back(pattern);
-                }
-            }
+    void gatherArtefacts(analysis_t &analysis)
+    {
+        auto &differences = analysis.workspace->differences;
+        auto &ratios = analysis.workspace->ratios;
+        differences.resize(analysis.sequence.size() - 1);
+        ratios.resize(analysis.sequence.size() - 1);
 
-            if(equal)
-            {
-                foundPatterns = patterns;
-                foundGap = gap;
-                break;
-            }
+        // gather differences and ratios between terms
+        const auto flags = extractArtefacts(analysis.sequence, differences.data(), ratios.data());
+        analysis.differences = differences;
+        analysis.ratios = ratios;
+        analysis.constantDifference = flags.constantDifference;
+        analysis.constantRatio = flags.constantRatio;
+        analysis.containsDecimals = flags.containsDecimals;
+        analysis.ambiguous = analysis.constantDifference && analysis.constantRatio;
+    }
+
+    /* quantizes a difference or ratio to the tolerance that solve() applies to terms of magnitude one, relative to
+     * its binary exponent, so that approximately equal artefacts share a symbol unless they straddle a rounding
+     * boundary: the exponent goes into the upper and the rounded mantissa into the lower half. NaN gets a symbol
+     * of its own per index and never matches, infinities match by sign */
+    uint64_t quantize(const double value, const size_t index)
+    {
+        if(std::isnan(value))
+            return uint64_t { 0x80000000 } << 32 | static_cast<uint32_t>(index);
+        if(std::isinf(value))
+            return uint64_t { 0x7FFFFFFF } << 32 | static_cast<uint32_t>(value < 0);
+
+        const double resolution = calculateSuitableEpsilon(1.0);
+        const int64_t steps = std::llround(1.0 / resolution);
+
+        int exponent = 0;
+        int64_t mantissa = std::llround(std::frexp(value, &exponent) / resolution);
+
+        // a mantissa that rounds up to one continues at one half of the next exponent
+        if(mantissa == steps || mantissa == -steps)
+        {
+            mantissa /= 2;
+            exponent++;
         }
 
-        if(!foundPatterns.empty())
+        return static_cast<uint64_t>(static_cast<uint32_t>(exponent)) << 32 | static_cast<uint32_t>(mantissa);
+    }
+
+    struct artefactSymbols_t
+    {
+        std::vector<uint64_t> differences;
+        std::vector<uint64_t> ratios;
+    };
+
+    void quantizeArtefacts(std::span<const double> differences, std::span<const double> ratios, artefactSymbols_t &symbols)
+    {
+        symbols.differences.resize(differences.size());
+        symbols.ratios.resize(ratios.size());
+
+        for(size_t i = 0; i < differences.size(); i++)
         {
-            const auto gap = foundGap;
+            symbols.differences[i] = quantize(differences[i], i);
+            symbols.ratios[i] = quantize(ratios[i], i);
+        }
+    }
+
+    inline bool matchingArtefacts(const artefactSymbols_t &symbols, const size_t a, const size_t b) {
+        return symbols.differences[a] == symbols.differences[b] || symbols.ratios[a] == symbols.ratios[b];
+    }
 
-            bool differencesOnly = true;
-            bool ratiosOnly = true;
-            bool quirkyRatios = false;
+    // z[i] is the length of the longest run from i that equals the symbols from the beginning, z[0] is 0
+    void zFunction(std::span<const uint64_t> symbols, std::vector<size_t> &z)
+    {
+        z.assign(symbols.size(), 0);
 
-            for(const auto &pattern : foundPatterns)
+        for(size_t i = 1, left = 0, right = 0; i < symbols.size(); i++)
+        {
+            if(i < right)
+                z[i] = std::min(right - i, z[i - left]);
+            while(i + z[i] < symbols.size() && symbols[z[i]] == symbols[i + z[i]])
+                z[i]++;
+            if(i + z[i] > right)
             {
-                differencesOnly &= pattern.operation == operation_t::ADDITION;
-                ratiosOnly &= pattern.operation == operation_t::MULTIPLICATION;
-                
-                if(!quirkyRatios && pattern.operation == operation_t::MULTIPLICATION && 
-                    !virtuallyInteger(pattern.operand, std::round(pattern.operand)))
-                    quirkyRatios = true;
+                left = i;
+                right = i + z[i];
             }
+        }
+    }
+
+    /* finds the largest gap from 2 on whose patterns hold for all artefacts, i.e. every artefact matches the one at
+     * its offset within the first gap in its difference or its ratio; returns 0 if there is none. A gap that repeats
+     * the differences or the ratios of the first gap all the way is a period of the respective symbols, which the
+     * Z-function yields for all gaps in linear time. A gap whose offsets repeat by different operations is checked
+     * artefact by artefact, but only beyond the longest run that either Z-function already vouches for */
+    uint32_t findPeriodicGap(const artefactSymbols_t &symbols)
+    {
+        const size_t count = symbols.differences.size();
+
+        std::vector<size_t> differenceRuns, ratioRuns;
+        zFunction(symbols.differences, differenceRuns);
+        zFunction(symbols.ratios, ratioRuns);
+
+        for(size_t gap = count - 1; gap > 1; gap--)
+        {
+            // equality of symbols is transitive, so a run of z symbols from the gap on repeats the first gap
+            size_t offset = gap + std::max(differenceRuns[gap], ratioRuns[gap]);
+
+            while(offset < count && matchingArtefacts(symbols, offset % gap, offset))
+                offset++;
+
+            if(offset == count)
+                return static_cast<uint32_t>(gap);
+        }
+
+        return 0;
+    }
+
+    // collects the patterns of the given gap, which holds for all artefacts, from its second repetition, which decides
+    // them; offsets without a second repetition are left to the caller
+    void matchPatterns(const analysis_t &analysis, const artefactSymbols_t &symbols, const uint32_t gap,
+        std::vector<pattern_t> &patterns)
+    {
+        const size_t end = std::min<size_t>(analysis.differences.size(), 2 * size_t(gap));
+        for(size_t offset = gap; offset < end; offset++)
+        {
+            const bool sameDifference = symbols.differences[offset % gap] == symbols.differences[offset];
+
+            pattern_t pattern;
+            pattern.gap = gap;
+            pattern.offset = offset;
+            pattern.operation = sameDifference ? operation_t::ADDITION : operation_t::MULTIPLICATION;
+            pattern.operand = sameDifference ? analysis.differences[offset % gap] : analysis.ratios[offset % gap];
+            patterns.emplace_back(pattern);
+        }
+    }
+
+    detection_t patternDetection(const sequenceType_t sequenceType, const operation_t operation, const double operand)
+    {
+        pattern_t pattern {};
+        pattern.operation = operation;
+        pattern.operand = operand;
+        pattern.gap = 1;
+
+        return detection_t { sequenceType, continuation_t { { pattern }, {} } };
+    }
+
+    void detectArithmetic(const analysis_t &analysis, const solverContext_t &context, std::vector<detection_t> &detections)
+    {
+        if((analysis.ambiguous && context.allowMultiplePredictions) || analysis.constantDifference)
+            detections.push_back(patternDetection(sequenceType_t::ARITHMETIC, operation_t::ADDITION, analysis.differences[0]));
+    }
+
+    void detectGeometric(const analysis_t &analysis, const solverContext_t &context, std::vector<detection_t> &detections)
+    {
+        if((analysis.ambiguous && context.allowMultiplePredictions) || analysis.constantRatio)
+            detections.push_back(patternDetection(sequenceType_t::GEOMETRIC, operation_t::MULTIPLICATION, analysis.ratios[0]));
+    }
+
+    void detectPeriodicPattern(const analysis_t &analysis, const solverContext_t &context, std::vector<detection_t> &detections)
+    {
+        std::vector<pattern_t> foundPatterns;
+
+        artefactSymbols_t quantizedSymbols;
+        if(!analysis.symbols)
+            quantizeArtefacts(analysis.differences, analysis.ratios, quantizedSymbols);
+        const auto &symbols = analysis.symbols ? *analysis.symbols : quantizedSymbols;
+
+        const uint32_t foundGap = analysis.periodicGapKnown ? static_cast<uint32_t>(analysis.periodicGap) : findPeriodicGap(symbols);
+        if(foundGap != 0)
+            matchPatterns(analysis, symbols, foundGap, foundPatterns);
+
+        if(!foundPatterns.empty())
+        {
+            const auto gap = foundGap;
 
             for(uint32_t i = 0; i < 2; i++)
             {
-                prediction_t prediction {};
-                prediction.sequenceType = sequenceType_t::MIXED;
-
-                std::vector<pattern_t> patterns;
+                detection_t detection { sequenceType_t::MIXED, {} };
+                auto &patterns = detection.continuation.patterns;
 
                 for(uint32_t offset = 0; offset < foundGap; offset++)
                 {
-                    pattern_t pattern;
+                    pattern_t pattern {};
                     
                     if(offset < foundPatterns.size())
                         pattern = foundPatterns[offset];
                     else
                     {
-                        const auto &artefact = artefacts[offset];
-                        const bool differenceFirst = differencesOnly | quirkyRatios;
-
-                        bool quirkyRatio = !virtuallyInteger(artefact.ratio);
+                        bool quirkyRatio = !virtuallyInteger(analysis.ratios[offset]);
 
                         pattern.operation = quirkyRatio ? operation_t::ADDITION : operation_t::MULTIPLICATION;
-                        pattern.operand = quirkyRatio ? artefact.difference : artefact.ratio;
+                        pattern.operand = quirkyRatio ? analysis.differences[offset] : analysis.ratios[offset];
                     }
 
-                    std::string description = fmt::format("s({}n+{}) = ", gap, (offset + 1) % gap);
-                    if(pattern.operation == operation_t::MULTIPLICATION)
-                        description += fmt::format("{}", pattern.operand);
-                    description += "s(n-1)";
-                    if(pattern.operation == operation_t::ADDITION)
-                        description += fmt::format(" {} {}", pattern.operand < 0 ? "-" : "+", std::abs(pattern.operand));
-
-                    prediction.descriptionList.emplace_back(description);
                     patterns.emplace_back(pattern);
                 }
 
-                calculatePredictions(sequence, prediction.predictedContinuation, context.requiredPredictedContinuationCount, 
-                    [&patterns, gap](double previousNumber, size_t newIndex) -> double {
-                        auto index = (newIndex - 1) % gap;
-                        auto pattern = patterns[index];
-                        if(pattern.operation == operation_t::ADDITION)
-                            return previousNumber + pattern.operand;
-                        else //if(pattern.operation == operation_t::MULTIPLICATION)
-                            return previousNumber * pattern.operand;
-                    });
-
-                result.predictions.emplace_back(prediction);
+                detections.push_back(std::move(detection));
                 
                 if(!context.allowMultiplePredictions)
-                    return result;
+                    return;
 
-                if(gap == foundPatterns.size())
+                if(analysis.differences.size() == 2 * size_t(gap))
                     break;
             }
         }
+    }
+
+    /* builds the finite difference table row by row from the differences on, up to the maximum degree of the context,
+     * and stops at the first row whose entries all match; the constant row has to hold at least two entries. Degrees
+     * below 2 are left to the arithmetic detector. The entries are compared relative to each other rather than with
+     * the epsilon of their magnitude, which would take any two entries of large sequences for equal, so that a scaled
+     * sequence keeps its degree. A quadratic is TRIANGULAR if its roots lie one apart, i.e. it is a multiple of a
+     * shifted triangular number, SQUARE if it has a double root, i.e. it is a multiple of a shifted square, and a
+     * POLYNOMIAL like any other otherwise */
+    void detectPolynomial(const analysis_t &analysis, const solverContext_t &context, std::vector<detection_t> &detections)
+    {
+        if(analysis.constantDifference || analysis.sequence.size() < 4)
+            return;
 
-        // quick and dirty approach to set a reasonable epsilon value for approximate equality comparison
-        const double equalityEpsilon = calculateSuitableEpsilon(sequence);
+        const size_t maximumDegree = std::min<size_t>(std::max(context.maximumPolynomialDegree, 0), analysis.sequence.size() - 2);
 
-        // calculate maximum determinable linear recurrence order for the given sequence
-        const int maximumOrder = static_cast<int>(sequence.size()) >> 1;
+        const double epsilon = calculateSuitableEpsilon(1.0);
+        auto &row = analysis.workspace->differenceRow;
+        if(!analysis.polynomialDegreeKnown)
+            row.assign(analysis.differences.begin(), analysis.differences.end());
 
-        /* check if sequence is linear recursive:
-         *  sequence size needs to be at least order*2 in order to have enough rows in our sparse matrix 
-         *  to find a linear combination and thus all linear recursive coefficients */
-        for(int order = maximumOrder; order > 0; order--)
+        for(uint32_t degree = 2; degree <= maximumDegree; degree++)
         {
-            using namespace Eigen;
-            using Triplet = Triplet<double>;
+            bool constant = !analysis.polynomialDegreeKnown || degree == analysis.polynomialDegree;
+
+            // the next row is checked while it is computed
+            if(!analysis.polynomialDegreeKnown)
+            {
+                for(size_t i = 0; i + 1 < row.size(); i++)
+                {
+                    row[i] = row[i + 1] - row[i];
+                    constant &= i == 0 || approximatelyEqual(row[i - 1], row[i], epsilon);
+                }
+                row.pop_back();
+            }
 
-            SparseMatrix<double> matrix(order, order);
-            VectorXd constants(order);
-            std::vector<Triplet> tripletList;
-            tripletList.reserve(order * order);
+            if(!constant)
+                continue;
 
-            for(int i = 0; i < order; i++)
+            sequenceType_t sequenceType = degree == 3 ? sequenceType_t::CUBIC : sequenceType_t::POLYNOMIAL;
+            if(degree == 2)
             {
-                for(int j = 0, k = i; j < order; j++, k++)
-                    tripletList.push_back(Triplet(i, j, sequence[k]));
-                constants[i] = sequence[i + order];
+                const auto polynomial = polynomialCoefficients(analysis.sequence, degree);
+                const double linear = polynomial[1] * polynomial[1];
+                const double product = 4.0 * polynomial[2] * polynomial[0];
+                if(approximatelyEqual(linear - product, polynomial[2] * polynomial[2], epsilon))
+                    sequenceType = sequenceType_t::TRIANGULAR;
+                else if(approximatelyEqual(linear, product, epsilon))
+                    sequenceType = sequenceType_t::SQUARE;
             }
 
-            matrix.setFromTriplets(tripletList.begin(), tripletList.end());      
-            BiCGSTAB<SparseMatrix<double>> solver;
-            
-            solver.compute(matrix);
+            detection_t detection { sequenceType, {} };
+            detection.continuation.degree = degree;
+            detections.push_back(std::move(detection));
+            return;
+        }
+    }
+
+    void detectLinearRecurrence(const analysis_t &analysis, const solverContext_t &context, std::vector<detection_t> &detections)
+    {
+        // calculate maximum determinable linear recurrence order for the given sequence, capped by the context
+        const size_t maximumOrder = std::min<size_t>(analysis.sequence.size() >> 1, std::max(context.maximumRecurrenceOrder, 0));
 
-            // decomposition failed
-            if(solver.info() != Success)
-                continue;
+        /* check if sequence is linear recursive:
+         *  sequence size needs to be at least order*2 in order to determine all linear recursive coefficients,
+         *  so a minimal recurrence of a higher order is not trusted */
+        auto &finder = analysis.workspace->recurrenceFinder;
+        auto &coefficients = analysis.workspace->coefficients;
+        bool found = analysis.recurrenceFound;
+        std::span<const double> recurrence = analysis.recurrence;
+        if(!analysis.recurrenceKnown)
+        {
+            finder.reset(maximumOrder);
+            for(size_t n = 0; n < analysis.sequence.size() && finder.push(analysis.sequence, n); n++);
+            found = finder.recurrence(maximumOrder, coefficients);
+            recurrence = coefficients;
+        }
 
-            VectorXd coefficientsVector = solver.solve(constants);
+        if(found)
+            detections.push_back(detection_t { sequenceType_t::LINEAR_RECURSIVE,
+                continuation_t { {}, std::vector<double>(recurrence.begin(), recurrence.end()) } });
+    }
 
-            // solving failed
-            if(solver.info() != Success)
-                continue;
+    enum class detectorCapability_t : uint32_t
+    {
+        NONE = 0,
+        // the detector reads the differences and ratios between terms
+        ARTEFACTS = 1 << 0,
+        // the predictions of the detector are dropped if an earlier detector already predicted the same continuation
+        DEDUPLICATED = 1 << 1
+    };
+
+    inline constexpr bool operator&(const detectorCapability_t a, const detectorCapability_t b) {
+        return (static_cast<uint32_t>(a) & static_cast<uint32_t>(b)) != 0;
+    }
+
+    inline constexpr detectorCapability_t operator|(const detectorCapability_t a, const detectorCapability_t b) {
+        return static_cast<detectorCapability_t>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+    }
+
+    struct detectorEntry_t
+    {
+        detector_t detector;
+        // relative cost class, detectors of the same cost keep their registration order
+        uint32_t cost;
+        detectorCapability_t capabilities;
+        void (*detect)(const analysis_t &analysis, const solverContext_t &context, std::vector<detection_t> &detections);
+    };
+
+    // all detectors ordered by their cost estimate; new detectors are registered here
+    const std::vector<detectorEntry_t> &detectorRegistry()
+    {
+        static const std::vector<detectorEntry_t> registry = []() {
+            std::vector<detectorEntry_t> registry {
+                { detector_t::ARITHMETIC, 1, detectorCapability_t::ARTEFACTS, detectArithmetic },
+                { detector_t::GEOMETRIC, 1, detectorCapability_t::ARTEFACTS, detectGeometric },
+                { detector_t::POLYNOMIAL, 2, detectorCapability_t::ARTEFACTS, detectPolynomial },
+                { detector_t::PERIODIC_PATTERN, 3, detectorCapability_t::ARTEFACTS, detectPeriodicPattern },
+                { detector_t::LINEAR_RECURRENCE, 4, detectorCapability_t::DEDUPLICATED, detectLinearRecurrence }
+            };
+
+            std::stable_sort(registry.begin(), registry.end(), [](const detectorEntry_t &a, const detectorEntry_t &b) {
+                return a.cost < b.cost;
+            });
+            return registry;
+        }();
+
+        return registry;
+    }
+
+    // the resource that the predictions of a solution are allocated from
+    inline std::pmr::memory_resource *memoryResource(const solverContext_t &context) {
+        return context.memoryResource != nullptr ? context.memoryResource : std::pmr::get_default_resource();
+    }
+
+    // sequences of at most one term are not handed to the detectors
+    solution_t solveTrivial(std::span<const double> sequence, const solverContext_t &context)
+    {
+        solution_t result { predictions_t(memoryResource(context)) };
+
+        if(sequence.size() == 1)
+        {
+            prediction_t prediction(memoryResource(context));
+            prediction.sequenceType = sequenceType_t::UNSPECIFIED;
+            prediction.predictedContinuation.assign(context.requiredPredictedContinuationCount, sequence[0]);
+            result.predictions.emplace_back(std::move(prediction));
+        }
+
+        return result;
+    }
+
+    std::vector<const detectorEntry_t*> enabledDetectors(const solverContext_t &context)
+    {
+        std::vector<const detectorEntry_t*> detectors;
+        for(const auto &entry : detectorRegistry())
+            if(context.enabledDetectors & entry.detector)
+                detectors.push_back(&entry);
+
+        return detectors;
+    }
+
+    /* threads that stay alive from one solve to the next to run the detectors of a sequence side by side. Every
+     * thread keeps a workspace of its own, so that detectors that run at the same time never share their buffers */
+    class detectorPool_c
+    {
+    public:
+        static detectorPool_c &instance()
+        {
+            static detectorPool_c pool(std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1);
+            return pool;
+        }
 
-            if(coefficientsVector.size() > 0)
+        ~detectorPool_c()
+        {
             {
-                prediction_t prediction {};
-                prediction.sequenceType = sequenceType_t::LINEAR_RECURSIVE;
-
-                // convert VectorXd to vector<double>
-                std::vector<double> coefficients(coefficientsVector.size());
-                VectorXd::Map(&coefficients[0], coefficientsVector.size()) = coefficientsVector;
-
-                calculateRecursivePredictions(sequence, prediction.predictedContinuation, context.requiredPredictedContinuationCount, 
-                    [&coefficients](const sequence_t &sequence, size_t newIndex) -> double {
-                        double result = 0.0;
-                        for(size_t i = 0; i < coefficients.size(); i++)
-                        {
-                            double coefficient = coefficients[i];
-                            size_t index = newIndex - coefficients.size() + i;
-                            result += coefficient * sequence[index];
-                        }
-                        return result;
-                    });
-
-                bool predictionAlreadyMade = false;
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
 
-                for(auto it = result.predictions.begin(); it != result.predictions.end() && !predictionAlreadyMade; it++)
-                    predictionAlreadyMade |= approximatelyEqual(prediction.predictedContinuation, it->predictedContinuation, equalityEpsilon);
+            for(auto &thread : threads)
+                thread.join();
+        }
 
-                if(predictionAlreadyMade)
-                    continue;
+        /* calls task for every index below count, each with the workspace of the thread it runs on, and returns once
+         * all calls returned; the calling thread takes part with the given workspace, so that the calls finish even if
+         * every thread of the pool is busy with the detectors of other sequences */
+        void run(const size_t count, workspace_t &workspace, const std::function<void(size_t, workspace_t&)> &task)
+        {
+            job_t job { task, count };
 
-                for(uint32_t i = 0; i < order; i++)
-                    prediction.descriptionList.emplace_back(fmt::format("s({}) = {}", i, sequence[i]));
+            std::unique_lock<std::mutex> lock(mutex);
+            jobs.push_back(&job);
+            wake.notify_all();
 
-                std::stringstream ss;
-                ss << "s(n) =";
-                for(size_t i = 0; i < coefficients.size(); i++)
-                {
-                    double coefficient = coefficients[coefficients.size() - i - 1];
-                    std::string coeffStr = std::to_string(std::abs(coefficient));
-                    coeffStr.erase(coeffStr.find_last_not_of('0') + 1, std::string::npos);
-                    coeffStr.erase(coeffStr.find_last_not_of('.') + 1, std::string::npos);
-
-                    ss << " ";
-                    if(i == 0 && coefficient < 0) ss << "-";
-                    else if(i > 0) ss << (coefficient < 0 ? "- " : "+ ");
-                    if(!approximatelyEqual(std::abs(coefficient), 1.0, 0.0001))
-                        ss << coeffStr;
-                    ss << "s(n-" << (i + 1) << ")";
-                }
+            while(job.next < job.count)
+                execute(job, workspace, lock);
 
-                prediction.descriptionList.emplace_back(ss.str());
-                result.predictions.emplace_back(prediction);
-                
-                if(!context.allowMultiplePredictions)
-                    return result;
+            done.wait(lock, [&job]() { return job.finished == job.count; });
+        }
+
+    private:
+        struct job_t
+        {
+            const std::function<void(size_t, workspace_t&)> &task;
+            size_t count;
+            size_t next = 0;
+            size_t finished = 0;
+        };
+
+        explicit detectorPool_c(const size_t threadCount)
+        {
+            for(size_t i = 0; i < threadCount; i++)
+                threads.emplace_back([this]() { work(); });
+        }
+
+        // claims the next index of the job and calls the task for it without holding the lock; a job leaves the
+        // queue as soon as its last index is claimed
+        void execute(job_t &job, workspace_t &workspace, std::unique_lock<std::mutex> &lock)
+        {
+            const size_t index = job.next++;
+            if(job.next == job.count)
+                jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+
+            lock.unlock();
+            job.task(index, workspace);
+            lock.lock();
+
+            if(++job.finished == job.count)
+                done.notify_all();
+        }
+
+        void work()
+        {
+            workspace_t workspace;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            while(true)
+            {
+                wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if(jobs.empty())
+                    return;
+
+                execute(*jobs.front(), workspace, lock);
             }
         }
 
-        return result;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        std::deque<job_t*> jobs;
+        bool stopping = false;
+        std::vector<std::thread> threads;
+    };
+
+    // runs the detectors in registry order, which keeps the solution deterministic
+    std::vector<detection_t> collectDetections(const analysis_t &analysis, const solverContext_t &context,
+        const std::vector<const detectorEntry_t*> &detectors)
+    {
+        std::vector<detection_t> result;
+
+        auto merge = [&result](const detectorEntry_t &entry, std::vector<detection_t> &detections)
+        {
+            for(auto &detection : detections)
+            {
+                detection.deduplicated = entry.capabilities & detectorCapability_t::DEDUPLICATED;
+                result.emplace_back(std::move(detection));
+            }
+        };
+
+        // all detectors run anyway if multiple predictions are allowed, so they may run side by side, each on the
+        // analysis with the workspace of its thread
+        if(context.allowMultiplePredictions && context.parallelDetectors && detectors.size() > 1)
+        {
+            std::vector<std::vector<detection_t>> detections(detectors.size());
+            std::vector<std::exception_ptr> exceptions(detectors.size());
+
+            detectorPool_c::instance().run(detectors.size(), *analysis.workspace, [&](const size_t i, workspace_t &workspace) {
+                try
+                {
+                    analysis_t detectorAnalysis = analysis;
+                    detectorAnalysis.workspace = &workspace;
+                    detectors[i]->detect(detectorAnalysis, context, detections[i]);
+                }
+                catch(...)
+                {
+                    exceptions[i] = std::current_exception();
+                }
+            });
+
+            for(const auto &exception : exceptions)
+                if(exception)
+                    std::rethrow_exception(exception);
+
+            for(size_t i = 0; i < detectors.size(); i++)
+                merge(*detectors[i], detections[i]);
+
+            return result;
+        }
+
+        // cheap detectors run first and the pipeline stops as soon as a single prediction suffices
+        for(const auto *entry : detectors)
+        {
+            std::vector<detection_t> detections;
+            entry->detect(analysis, context, detections);
+            merge(*entry, detections);
+
+            if(!context.allowMultiplePredictions && !result.empty())
+                return result;
+        }
+
+        return result;
+    }
+
+    // derives the predictions of the required number of terms and their descriptions from the detections
+    solution_t assembleSolution(std::span<const double> sequence, const std::vector<detection_t> &detections,
+        const solverContext_t &context)
+    {
+        auto *resource = memoryResource(context);
+        solution_t result { predictions_t(resource) };
+        // predictions are compared under the tolerance of the last term
+        const toleranceModel_c tolerance(sequence);
+
+        for(const auto &detection : detections)
+        {
+            prediction_t prediction(resource);
+            prediction.sequenceType = detection.sequenceType;
+            continueSequence(detection.continuation, sequence, prediction.predictedContinuation,
+                context.requiredPredictedContinuationCount);
+
+            bool predictionAlreadyMade = false;
+
+            if(detection.deduplicated)
+            {
+                for(auto it = result.predictions.begin(); it != result.predictions.end() && !predictionAlreadyMade; it++)
+                    predictionAlreadyMade |= tolerance.allEqual(prediction.predictedContinuation, it->predictedContinuation);
+            }
+
+            if(!predictionAlreadyMade)
+            {
+                assignRule(detection, sequence, prediction.rule);
+                result.predictions.emplace_back(std::move(prediction));
+            }
+        }
+
+        return result;
+    }
+
+    solution_t runDetectors(const analysis_t &analysis, const solverContext_t &context,
+        const std::vector<const detectorEntry_t*> &detectors)
+    {
+        return assembleSolution(analysis.sequence, collectDetections(analysis, context, detectors), context);
+    }
+
+    // thread-safe least recently used cache of detections keyed by the fingerprint of the sequence they were found in
+    class solutionCache_c
+    {
+    public:
+        struct entry_t
+        {
+            std::vector<detection_t> detections;
+        };
+
+        static solutionCache_c &instance()
+        {
+            static solutionCache_c cache;
+            return cache;
+        }
+
+        /* the context fields that decide which detectors run and what they find, followed by the exact bits of every
+         * term, so that a hit gives the same solution as solve(). Neither a rounding of the terms to the tolerance nor a
+         * division by a scale would: the recurrence detector already finds other coefficients for a scaled copy of an
+         * ill-conditioned sequence, whose terms divided by the scale are the same to the last bit. Returns an empty key
+         * if a term is not finite */
+        static std::string fingerprint(const sequence_t &sequence, const solverContext_t &context)
+        {
+            std::string key;
+            key.reserve(4 * sizeof(int32_t) + sequence.size() * sizeof(double));
+            auto append = [&key](const auto value) {
+                key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            };
+
+            append(static_cast<int32_t>(context.allowMultiplePredictions));
+            append(static_cast<int32_t>(context.maximumRecurrenceOrder));
+            append(static_cast<int32_t>(context.maximumPolynomialDegree));
+            append(static_cast<uint32_t>(context.enabledDetectors));
+
+            for(const double term : sequence)
+            {
+                if(!std::isfinite(term))
+                    return {};
+                append(term);
+            }
+
+            return key;
+        }
+
+        inline bool enabled() const {
+            return capacity.load(std::memory_order_relaxed) != 0;
+        }
+
+        std::shared_ptr<const entry_t> find(const std::string &key)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            auto find = index.find(key);
+            if(find == index.end())
+            {
+                misses++;
+                return nullptr;
+            }
+
+            hits++;
+
+            entries.splice(entries.begin(), entries, find->second);
+            return find->second->second;
+        }
+
+        void insert(const std::string &key, std::shared_ptr<const entry_t> entry)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if(capacity == 0 || index.count(key))
+                return;
+
+            entries.emplace_front(key, std::move(entry));
+            index.insert({ key, entries.begin() });
+            evict();
+        }
+
+        void setCapacity(const size_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->capacity = capacity;
+            evict();
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.clear();
+            index.clear();
+            hits = 0;
+            misses = 0;
+        }
+
+        solutionCacheStatistics_t statistics()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return solutionCacheStatistics_t { hits, misses, entries.size(), capacity };
+        }
+
+    private:
+        void evict()
+        {
+            while(entries.size() > capacity)
+            {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+        }
+
+        std::mutex mutex;
+        std::list<std::pair<std::string, std::shared_ptr<const entry_t>>> entries;
+        std::unordered_map<std::string, decltype(entries)::iterator> index;
+        // read without the lock to skip the fingerprint while the cache is disabled
+        std::atomic<size_t> capacity = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    /* detections in the solution store are laid out as
+     *  - uint32 number of detections, and per detection
+     *  - uint32 sequence type, uint8 whether it is deduplicated,
+     *  - uint32 number of patterns followed by an uint32 operation and a double operand per pattern,
+     *  - uint32 number of coefficients followed by the coefficients as doubles,
+     *  - uint32 polynomial degree
+     * in the byte order of the machine */
+    template<typename T>
+    void appendBytes(std::string &bytes, const T value) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool readBytes(std::string_view &bytes, T &value)
+    {
+        if(bytes.size() < sizeof(T))
+            return false;
+
+        std::memcpy(&value, bytes.data(), sizeof(T));
+        bytes.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    std::string serializeDetections(const std::vector<detection_t> &detections)
+    {
+        std::string bytes;
+        appendBytes(bytes, static_cast<uint32_t>(detections.size()));
+
+        for(const auto &detection : detections)
+        {
+            appendBytes(bytes, static_cast<uint32_t>(detection.sequenceType));
+            appendBytes(bytes, static_cast<uint8_t>(detection.deduplicated));
+
+            appendBytes(bytes, static_cast<uint32_t>(detection.continuation.patterns.size()));
+            for(const auto &pattern : detection.continuation.patterns)
+            {
+                appendBytes(bytes, static_cast<uint32_t>(pattern.operation));
+                appendBytes(bytes, pattern.operand);
+            }
+
+            appendBytes(bytes, static_cast<uint32_t>(detection.continuation.coefficients.size()));
+            for(const double coefficient : detection.continuation.coefficients)
+                appendBytes(bytes, coefficient);
+
+            appendBytes(bytes, detection.continuation.degree);
+        }
+
+        return bytes;
+    }
+
+    // returns false if the bytes end early, in which case the detections are incomplete
+    bool deserializeDetections(std::string_view bytes, const size_t termCount, std::vector<detection_t> &detections)
+    {
+        uint32_t detectionCount = 0;
+        if(!readBytes(bytes, detectionCount))
+            return false;
+
+        for(uint32_t i = 0; i < detectionCount; i++)
+        {
+            uint32_t sequenceType = 0, patternCount = 0, coefficientCount = 0;
+            uint8_t deduplicated = 0;
+            if(!readBytes(bytes, sequenceType) || !readBytes(bytes, deduplicated) || !readBytes(bytes, patternCount))
+                return false;
+
+            // the counts are checked against the remaining bytes before anything is reserved for them
+            if(patternCount > bytes.size() / (sizeof(uint32_t) + sizeof(double)))
+                return false;
+
+            detection_t detection { static_cast<sequenceType_t>(sequenceType), {} };
+            detection.deduplicated = deduplicated != 0;
+            detection.continuation.patterns.resize(patternCount);
+            for(auto &pattern : detection.continuation.patterns)
+            {
+                uint32_t operation = 0;
+                if(!readBytes(bytes, operation) || !readBytes(bytes, pattern.operand))
+                    return false;
+                pattern.operation = static_cast<operation_t>(operation);
+            }
+
+            if(!readBytes(bytes, coefficientCount) || coefficientCount > bytes.size() / sizeof(double))
+                return false;
+
+            detection.continuation.coefficients.resize(coefficientCount);
+            for(auto &coefficient : detection.continuation.coefficients)
+                readBytes(bytes, coefficient);
+
+            if(!readBytes(bytes, detection.continuation.degree))
+                return false;
+
+            // a record that reaches back beyond the terms or has no kernel to continue them is not trusted
+            const auto &continuation = detection.continuation;
+            if(lookback(continuation) > termCount)
+                return false;
+            if(continuation.degree == 0 && continuation.coefficients.empty() && continuation.patterns.empty())
+                return false;
+
+            detections.push_back(std::move(detection));
+        }
+
+        return bytes.empty();
+    }
+
+    // the solution store that is opened by openSolutionStore(), shared with the calls that are looking it up while
+    // it is replaced or closed
+    std::mutex solutionStoreMutex;
+    std::shared_ptr<mappedStore_c> solutionStore;
+    // set while a store is open, so that the calls only take the mutex if there is a store to look up
+    std::atomic<bool> solutionStoreOpen = false;
+
+    std::shared_ptr<mappedStore_c> currentSolutionStore()
+    {
+        if(!solutionStoreOpen.load(std::memory_order_acquire))
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(solutionStoreMutex);
+        return solutionStore;
+    }
+
+    solution_t solveInWorkspace(const sequence_t &sequence, const solverContext_t &context, workspace_t &workspace)
+    {
+        if(sequence.size() <= 1)
+            return solveTrivial(sequence, context);
+
+        auto &cache = solutionCache_c::instance();
+        const auto store = currentSolutionStore();
+        const std::string key = cache.enabled() || store ? solutionCache_c::fingerprint(sequence, context) : std::string {};
+
+        if(auto entry = key.empty() || !cache.enabled() ? nullptr : cache.find(key))
+            return assembleSolution(sequence, entry->detections, context);
+
+        if(store && !key.empty())
+        {
+            std::vector<detection_t> detections;
+            if(const auto bytes = store->find(key); bytes && deserializeDetections(*bytes, sequence.size(), detections))
+            {
+                if(cache.enabled())
+                    cache.insert(key, std::make_shared<const solutionCache_c::entry_t>(solutionCache_c::entry_t { detections }));
+                return assembleSolution(sequence, detections, context);
+            }
+        }
+
+        const auto detectors = enabledDetectors(context);
+
+        bool artefactsRequired = false;
+        for(const auto *entry : detectors)
+            artefactsRequired |= entry->capabilities & detectorCapability_t::ARTEFACTS;
+
+        analysis_t analysis { sequence, &workspace, {}, {} };
+        if(artefactsRequired)
+            gatherArtefacts(analysis);
+
+        auto detections = collectDetections(analysis, context, detectors);
+        if(!key.empty() && cache.enabled())
+            cache.insert(key, std::make_shared<const solutionCache_c::entry_t>(solutionCache_c::entry_t { detections }));
+        // a full store keeps what it has, which is why a failed insert is not reported
+        if(!key.empty() && store && store->writable())
+            store->insert(key, serializeDetections(detections));
+
+        return assembleSolution(sequence, detections, context);
+    }
+
+    solution_t solve(const sequence_t &sequence, const solverContext_t &context)
+    {
+        workspace_t workspace;
+        return solveInWorkspace(sequence, context, workspace);
+    }
+
+    void setSolutionCacheCapacity(const size_t capacity) {
+        solutionCache_c::instance().setCapacity(capacity);
+    }
+
+    void clearSolutionCache() {
+        solutionCache_c::instance().clear();
+    }
+
+    solutionCacheStatistics_t solutionCacheStatistics() {
+        return solutionCache_c::instance().statistics();
+    }
+
+    bool openSolutionStore(const std::string &path, const bool writable, const size_t capacity)
+    {
+        std::shared_ptr<mappedStore_c> store = mappedStore_c::open(path, writable, capacity);
+        if(!store)
+            return false;
+
+        std::lock_guard<std::mutex> lock(solutionStoreMutex);
+        solutionStore = std::move(store);
+        solutionStoreOpen.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void closeSolutionStore()
+    {
+        std::lock_guard<std::mutex> lock(solutionStoreMutex);
+        solutionStoreOpen.store(false, std::memory_order_release);
+        solutionStore.reset();
+    }
+
+    std::vector<solution_t> solveBatch(std::span<const sequence_t> sequences, const solverContext_t &context)
+    {
+        // every solution is allocated from the memory resource of the context up front, since moving one of another
+        // resource into it would copy the predictions
+        std::vector<solution_t> solutions;
+        solutions.reserve(sequences.size());
+        for(size_t i = 0; i < sequences.size(); i++)
+            solutions.push_back(solution_t { predictions_t(memoryResource(context)) });
+
+        // the batch is already spread over all workers, so detectors of a single sequence do not get threads of their own
+        solverContext_t batchContext = context;
+        batchContext.parallelDetectors = false;
+
+        const size_t hardwareThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        const size_t workerCount = std::max<size_t>(std::min(context.workerCount == 0 ? hardwareThreads : context.workerCount,
+            sequences.size()), 1);
+
+        // every worker owns a contiguous range of sequences that it works through from the front; once its range is
+        // exhausted it steals single sequences from the ranges of the others
+        struct range_t
+        {
+            std::atomic<size_t> next;
+            size_t end;
+        };
+
+        std::vector<range_t> ranges(workerCount);
+        for(size_t worker = 0; worker < workerCount; worker++)
+        {
+            ranges[worker].next = sequences.size() * worker / workerCount;
+            ranges[worker].end = sequences.size() * (worker + 1) / workerCount;
+        }
+
+        std::vector<std::exception_ptr> exceptions(workerCount);
+
+        auto work = [&](const size_t worker)
+        {
+            try
+            {
+                workspace_t workspace;
+
+                for(size_t victim = 0; victim < workerCount; victim++)
+                {
+                    auto &range = ranges[(worker + victim) % workerCount];
+                    for(size_t index = range.next++; index < range.end; index = range.next++)
+                        solutions[index] = solveInWorkspace(sequences[index], batchContext, workspace);
+                }
+            }
+            catch(...)
+            {
+                exceptions[worker] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for(size_t worker = 1; worker < workerCount; worker++)
+            workers.emplace_back(work, worker);
+
+        work(0);
+
+        for(auto &worker : workers)
+            worker.join();
+
+        for(const auto &exception : exceptions)
+            if(exception)
+                std::rethrow_exception(exception);
+
+        return solutions;
+    }
+
+    struct periodicCandidate_t
+    {
+        size_t gap;
+        size_t offset;
+    };
+
+    struct onlineSolver_c::state_t
+    {
+        explicit state_t(const solverContext_t &context) : context(context), detectors(enabledDetectors(context))
+        {
+            workspace.recurrenceFinder.reset(std::max(context.maximumRecurrenceOrder, 0));
+            analysis.periodicGapKnown = true;
+            analysis.symbols = &symbols;
+            analysis.polynomialDegreeKnown = true;
+            analysis.recurrenceKnown = true;
+
+            const size_t maximumDegree = std::max(context.maximumPolynomialDegree, 0);
+            polynomialEntries.resize(maximumDegree + 1);
+            polynomialConstant.resize(maximumDegree + 1, true);
+        }
+
+        solverContext_t context;
+        std::vector<const detectorEntry_t*> detectors;
+        sequence_t sequence;
+        workspace_t workspace;
+        analysis_t analysis { sequence, &workspace, {}, {} };
+
+        // the gaps whose periodic patterns may still hold for all artefacts in ascending order, each with the first
+        // artefact that it has not been checked against; every other gap failed for good
+        std::vector<periodicCandidate_t> periodicCandidates;
+        std::vector<size_t> differenceRuns, ratioRuns;
+        artefactSymbols_t symbols;
+
+        // the last entry of every row of the finite difference table by degree, and whether the row is constant
+        std::vector<double> polynomialEntries;
+        std::vector<bool> polynomialConstant;
+    };
+
+    onlineSolver_c::onlineSolver_c(const solverContext_t &context) : state(std::make_unique<state_t>(context)) {}
+
+    onlineSolver_c::onlineSolver_c(onlineSolver_c &&other) noexcept = default;
+    onlineSolver_c &onlineSolver_c::operator=(onlineSolver_c &&other) noexcept = default;
+    onlineSolver_c::~onlineSolver_c() = default;
+
+    void onlineSolver_c::append(const double term)
+    {
+        auto &sequence = state->sequence;
+        auto &analysis = state->analysis;
+        auto &differences = state->workspace.differences;
+        auto &ratios = state->workspace.ratios;
+
+        sequence.push_back(term);
+        analysis.sequence = sequence;
+        state->workspace.recurrenceFinder.push(sequence, sequence.size() - 1);
+
+        if(sequence.size() < 2)
+            return;
+
+        appendArtefact(analysis, sequence.size() - 1);
+
+        /* a gap survives as long as every artefact matches the one at its offset within the first gap, so a gap that
+         * failed once never holds again. The new artefact opens the gap that ends right before it if it matches the
+         * first artefact, and the largest surviving gap is checked up to the new artefact until one holds; the gaps
+         * below it only catch up once they are on top. Catching up stale gaps artefact by artefact costs at most as
+         * much as the Z-functions, which vouch for the runs that repeat the first gap in linear time */
+        const size_t last = differences.size() - 1;
+        auto &candidates = state->periodicCandidates;
+        auto &symbols = state->symbols;
+
+        symbols.differences.push_back(quantize(differences[last], last));
+        symbols.ratios.push_back(quantize(ratios[last], last));
+
+        if(last >= 2 && matchingArtefacts(symbols, 0, last))
+            candidates.push_back({ last, last + 1 });
+
+        bool runsKnown = false;
+        size_t checked = 0;
+
+        while(!candidates.empty())
+        {
+            auto &candidate = candidates.back();
+
+            if(!runsKnown && checked + (last + 1 - candidate.offset) > last + 1)
+            {
+                zFunction(symbols.differences, state->differenceRuns);
+                zFunction(symbols.ratios, state->ratioRuns);
+                runsKnown = true;
+            }
+
+            // both the run and the checked artefacts start at the gap, so the artefacts below either end match
+            if(runsKnown)
+                candidate.offset = std::max(candidate.offset,
+                    candidate.gap + std::max(state->differenceRuns[candidate.gap], state->ratioRuns[candidate.gap]));
+
+            const size_t first = candidate.offset;
+            while(candidate.offset <= last && matchingArtefacts(symbols, candidate.offset % candidate.gap, candidate.offset))
+                candidate.offset++;
+            checked += candidate.offset - first;
+
+            if(candidate.offset > last)
+                break;
+
+            candidates.pop_back();
+        }
+
+        // the detector takes the largest gap, as it does when it searches by itself
+        analysis.periodicGap = candidates.empty() ? 0 : candidates.back().gap;
+
+        /* the new difference adds one entry to every row of the finite difference table that holds any, which is
+         * the difference of the last two entries of the row above, as it is when the detector builds the table */
+        auto &entries = state->polynomialEntries;
+        auto &constant = state->polynomialConstant;
+        const double epsilon = calculateSuitableEpsilon(1.0);
+        const size_t rows = std::min(entries.size() - 1, differences.size());
+
+        double entry = differences[last];
+        double previous = last > 0 ? differences[last - 1] : 0.0;
+        for(size_t degree = 2; degree <= rows; degree++)
+        {
+            const double next = entry - previous;
+            previous = entries[degree];
+            if(degree <= last)
+                constant[degree] = constant[degree] && approximatelyEqual(previous, next, epsilon);
+            entries[degree] = entry = next;
+        }
+
+        // the detector takes the lowest constant row that holds at least two entries
+        analysis.polynomialDegree = 0;
+        for(size_t degree = 2; degree <= rows && degree + 2 <= sequence.size(); degree++)
+        {
+            if(constant[degree])
+            {
+                analysis.polynomialDegree = degree;
+                break;
+            }
+        }
+    }
+
+    solution_t onlineSolver_c::solution() const
+    {
+        if(state->sequence.size() <= 1)
+            return solveTrivial(state->sequence, state->context);
+
+        /* the finder holds the minimal recurrence of all terms so far, which is only trusted up to half their count.
+         * Everything that depends on the count goes into a copy of the analysis, and the detectors find everything
+         * else in it, so that the state is only read and solutions can be taken from several threads at once */
+        analysis_t analysis = state->analysis;
+        std::vector<double> coefficients;
+        const size_t maximumOrder = std::min<size_t>(state->sequence.size() >> 1, std::max(state->context.maximumRecurrenceOrder, 0));
+        analysis.recurrenceFound = state->workspace.recurrenceFinder.recurrence(maximumOrder, coefficients);
+        analysis.recurrence = coefficients;
+
+        return runDetectors(analysis, state->context, state->detectors);
+    }
+
+    const sequence_t &onlineSolver_c::sequence() const {
+        return state->sequence;
+    }
+
+    struct windowedSolver_c::state_t
+    {
+        state_t(const size_t windowSize, const solverContext_t &context) :
+            windowSize(std::max<size_t>(windowSize, 1)), context(context), detectors(enabledDetectors(context)) {}
+
+        inline std::span<const double> window() const {
+            return std::span<const double>(terms).subspan(first);
+        }
+
+        inline std::span<const double> windowDifferences() const {
+            return std::span<const double>(differences).subspan(first);
+        }
+
+        inline std::span<const double> windowRatios() const {
+            return std::span<const double>(ratios).subspan(first);
+        }
+
+        size_t windowSize;
+        solverContext_t context;
+        std::vector<const detectorEntry_t*> detectors;
+        workspace_t workspace;
+
+        // the window starts at an offset into the buffers, which are compacted once the offset reaches the window
+        // size so that every term is moved a constant number of times; differences[i] and ratios[i] lie between
+        // terms[i] and terms[i + 1], so the artefacts of the window start at the same offset
+        sequence_t terms;
+        std::vector<double> differences;
+        std::vector<double> ratios;
+        size_t first = 0;
+
+        // neighbouring artefacts in the window whose differences or ratios differ, and terms that are not integral
+        size_t differenceBreaks = 0;
+        size_t ratioBreaks = 0;
+        size_t decimalTerms = 0;
+
+        // set if the coefficients of the workspace hold the minimal recurrence of the window
+        bool recurrenceFound = false;
+    };
+
+    windowedSolver_c::windowedSolver_c(const size_t windowSize, const solverContext_t &context) :
+        state(std::make_unique<state_t>(windowSize, context)) {}
+
+    windowedSolver_c::windowedSolver_c(windowedSolver_c &&other) noexcept = default;
+    windowedSolver_c &windowedSolver_c::operator=(windowedSolver_c &&other) noexcept = default;
+    windowedSolver_c::~windowedSolver_c() = default;
+
+    void windowedSolver_c::push(const double term)
+    {
+        auto &terms = state->terms;
+        auto &differences = state->differences;
+        auto &ratios = state->ratios;
+        auto &first = state->first;
+
+        terms.push_back(term);
+        state->decimalTerms += !virtuallyInteger(term);
+
+        if(terms.size() > 1)
+        {
+            const double last = terms[terms.size() - 2];
+            differences.push_back(term - last);
+            ratios.push_back(term / last);
+
+            if(differences.size() - first > 1)
+            {
+                state->differenceBreaks += !sameArtefact(differences[differences.size() - 2], differences.back());
+                state->ratioBreaks += !sameArtefact(ratios[ratios.size() - 2], ratios.back());
+            }
+        }
+
+        // the oldest term leaves the window along with its artefact and the comparison of that to the next one
+        if(terms.size() - first > state->windowSize)
+        {
+            if(differences.size() - first > 1)
+            {
+                state->differenceBreaks -= !sameArtefact(differences[first], differences[first + 1]);
+                state->ratioBreaks -= !sameArtefact(ratios[first], ratios[first + 1]);
+            }
+
+            state->decimalTerms -= !virtuallyInteger(terms[first]);
+            first++;
+        }
+
+        if(first >= state->windowSize)
+        {
+            terms.erase(terms.begin(), terms.begin() + first);
+            differences.erase(differences.begin(), differences.begin() + first);
+            ratios.erase(ratios.begin(), ratios.begin() + first);
+            first = 0;
+        }
+
+        /* a recurrence that still generates the newest term stays the minimal one of the window: it generates all
+         * terms of the previous window and the new one, and a recurrence that can be run backwards cannot be
+         * shortened by dropping the oldest term as long as the window holds at least twice its order; only
+         * otherwise the window is searched again, in O(maximumOrder) per term */
+        const auto window = state->window();
+        auto &coefficients = state->workspace.coefficients;
+        const size_t maximumOrder = std::min<size_t>(window.size() >> 1, std::max(state->context.maximumRecurrenceOrder, 0));
+
+        if(state->recurrenceFound)
+            state->recurrenceFound = coefficients.size() <= maximumOrder && recurrenceFinder_c::reversible(coefficients) &&
+                recurrenceFinder_c::generates(coefficients, window, window.size() - 1);
+
+        if(!state->recurrenceFound)
+        {
+            auto &finder = state->workspace.recurrenceFinder;
+            finder.reset(maximumOrder);
+            for(size_t n = 0; n < window.size() && finder.push(window, n); n++);
+            state->recurrenceFound = finder.recurrence(maximumOrder, coefficients);
+        }
+    }
+
+    solution_t windowedSolver_c::solution() const
+    {
+        const auto window = state->window();
+        if(window.size() <= 1)
+            return solveTrivial(window, state->context);
+
+        // the polynomial detector builds its table in a workspace of its own, so that the state is only read
+        workspace_t workspace;
+        analysis_t analysis { window, &workspace, state->windowDifferences(), state->windowRatios() };
+        analysis.constantDifference = state->differenceBreaks == 0;
+        analysis.constantRatio = state->ratioBreaks == 0;
+        analysis.containsDecimals = state->decimalTerms != 0;
+        analysis.ambiguous = analysis.constantDifference && analysis.constantRatio;
+        analysis.recurrenceKnown = true;
+        analysis.recurrenceFound = state->recurrenceFound;
+        analysis.recurrence = state->workspace.coefficients;
+
+        return runDetectors(analysis, state->context, state->detectors);
+    }
+
+    std::span<const double> windowedSolver_c::window() const {
+        return state->window();
     }
 }
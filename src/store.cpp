@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    define NOMINMAX
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/file.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#include "store.h"
+
+namespace sequencer_n
+{
+    constexpr uint64_t STORE_MAGIC = 0x3152545351455300; // "\0SEQSTR1"
+    // also covers the layout of the keys, which are fingerprints of sequences, and of the values, which are stored
+    // detections
+    constexpr uint32_t STORE_VERSION = 3;
+    constexpr size_t STORE_RECORD_ALIGNMENT = 8;
+    // bytes of the file per bucket when a store is created, which leaves room for records of about 30 terms
+    constexpr size_t STORE_BYTES_PER_BUCKET = 512;
+
+    struct mappedStore_c::header_t
+    {
+        // written last when a file is created, so that a reader never takes a half initialized file for a store
+        uint64_t magic;
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t bucketCount;
+        uint64_t recordsBegin;
+        uint64_t recordsEnd;
+
+        // only read and written by the writing process
+        uint64_t nextRecord;
+        uint64_t entryCount;
+    };
+
+    struct mappedStore_c::bucket_t
+    {
+        uint64_t hash;
+        // offset of the record from the beginning of the file, 0 while the bucket is empty
+        uint64_t offset;
+    };
+
+    // FNV-1a
+    uint64_t hashKey(std::string_view key)
+    {
+        uint64_t hash = 0xcbf29ce484222325;
+        for(const char character : key)
+        {
+            hash ^= static_cast<uint8_t>(character);
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    std::unique_ptr<mappedStore_c> mappedStore_c::open(const std::string &path, const bool writable, const size_t capacity)
+    {
+        using namespace std;
+
+        std::unique_ptr<mappedStore_c> store(new mappedStore_c());
+        store->canWrite = writable;
+
+        auto fail = [&path](const char *reason) {
+            cerr << "\033[31mError: cannot open solution store " << path << ": " << reason << "\033[0m" << endl;
+            return nullptr;
+        };
+
+        bool created = false;
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(file == INVALID_HANDLE_VALUE)
+            return fail("file cannot be opened");
+        store->file = file;
+
+        // a lock on a byte far beyond the end of the file marks the writer without keeping readers from the file
+        OVERLAPPED overlapped {};
+        overlapped.Offset = 0xFFFFFFFF;
+        overlapped.OffsetHigh = 0x7FFFFFFF;
+        if(writable && !LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, 1, 0, &overlapped))
+            return fail("another process writes to it");
+
+        LARGE_INTEGER fileSize {};
+        if(!GetFileSizeEx(file, &fileSize))
+            return fail("file size cannot be determined");
+        store->size = static_cast<size_t>(fileSize.QuadPart);
+
+        if(store->size == 0 && writable)
+        {
+            store->size = capacity;
+            created = true;
+        }
+
+        if(store->size < sizeof(header_t))
+            return fail("file is too small");
+
+        // mapping a file that is opened for writing extends it to the size of the mapping, filled with zeros
+        const uint64_t mappingSize = store->size;
+        store->mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+            static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize & 0xFFFFFFFF), nullptr);
+        if(store->mapping == nullptr)
+            return fail("file cannot be mapped");
+
+        store->base = static_cast<uint8_t*>(MapViewOfFile(store->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, store->size));
+        if(store->base == nullptr)
+            return fail("file cannot be mapped");
+#else
+        store->descriptor = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if(store->descriptor < 0)
+            return fail("file cannot be opened");
+
+        // the advisory lock marks the writer and does not keep readers from the file
+        if(writable && flock(store->descriptor, LOCK_EX | LOCK_NB) != 0)
+            return fail("another process writes to it");
+
+        struct stat status {};
+        if(fstat(store->descriptor, &status) != 0)
+            return fail("file size cannot be determined");
+        store->size = static_cast<size_t>(status.st_size);
+
+        // a new file is extended with zeros, which the file system usually keeps sparse
+        if(store->size == 0 && writable)
+        {
+            if(ftruncate(store->descriptor, static_cast<off_t>(capacity)) != 0)
+                return fail("file cannot be resized");
+
+            store->size = capacity;
+            created = true;
+        }
+
+        if(store->size < sizeof(header_t))
+            return fail("file is too small");
+
+        void *base = mmap(nullptr, store->size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, store->descriptor, 0);
+        if(base == MAP_FAILED)
+            return fail("file cannot be mapped");
+        store->base = static_cast<uint8_t*>(base);
+#endif
+
+        auto &header = store->header();
+
+        // a file whose creation did not finish has no magic yet and one of another version cannot be read, so the
+        // writer starts both over in the size they have
+        const uint64_t magic = std::atomic_ref<uint64_t>(header.magic).load(std::memory_order_acquire);
+        const bool recreated = writable && !created && (magic == 0 || (magic == STORE_MAGIC && header.version != STORE_VERSION));
+
+        if(created || recreated)
+        {
+            const uint64_t bucketCount = std::bit_floor(std::max<uint64_t>(store->size / STORE_BYTES_PER_BUCKET, 1));
+            if(recreated)
+            {
+                std::atomic_ref<uint64_t>(header.magic).store(0, std::memory_order_release);
+                if(sizeof(header_t) + bucketCount * sizeof(bucket_t) <= store->size)
+                    std::memset(store->buckets(), 0, bucketCount * sizeof(bucket_t));
+            }
+
+            header.version = STORE_VERSION;
+            header.bucketCount = bucketCount;
+            header.recordsBegin = sizeof(header_t) + bucketCount * sizeof(bucket_t);
+            header.recordsEnd = store->size;
+            header.nextRecord = header.recordsBegin;
+            header.entryCount = 0;
+            std::atomic_ref<uint64_t>(header.magic).store(STORE_MAGIC, std::memory_order_release);
+        }
+
+        if(std::atomic_ref<uint64_t>(header.magic).load(std::memory_order_acquire) != STORE_MAGIC || header.version != STORE_VERSION)
+            return fail("file is no solution store");
+
+        if(!std::has_single_bit(header.bucketCount) || header.recordsBegin != sizeof(header_t) + header.bucketCount * sizeof(bucket_t) ||
+            header.recordsBegin > header.recordsEnd || header.recordsEnd > store->size)
+            return fail("file is corrupted");
+
+        return store;
+    }
+
+    mappedStore_c::~mappedStore_c()
+    {
+#ifdef _WIN32
+        if(base != nullptr)
+            UnmapViewOfFile(base);
+        if(mapping != nullptr)
+            CloseHandle(mapping);
+        if(file != nullptr)
+            CloseHandle(file);
+#else
+        if(base != nullptr)
+            munmap(base, size);
+        if(descriptor >= 0)
+            close(descriptor);
+#endif
+    }
+
+    mappedStore_c::header_t &mappedStore_c::header() const {
+        return *reinterpret_cast<header_t*>(base);
+    }
+
+    mappedStore_c::bucket_t *mappedStore_c::buckets() const {
+        return reinterpret_cast<bucket_t*>(base + sizeof(header_t));
+    }
+
+    std::optional<std::string_view> mappedStore_c::find(std::string_view key) const
+    {
+        const auto &header = this->header();
+        const uint64_t hash = hashKey(key);
+        const uint64_t mask = header.bucketCount - 1;
+
+        for(uint64_t probe = 0; probe < header.bucketCount; probe++)
+        {
+            auto &bucket = buckets()[(hash + probe) & mask];
+
+            // the record and the hash of a bucket are written before its offset is published
+            const uint64_t offset = std::atomic_ref<uint64_t>(bucket.offset).load(std::memory_order_acquire);
+            if(offset == 0)
+                return std::nullopt;
+
+            if(bucket.hash != hash)
+                continue;
+
+            uint32_t sizes[2];
+            if(offset < header.recordsBegin || offset + sizeof(sizes) > header.recordsEnd)
+                return std::nullopt;
+
+            std::memcpy(sizes, base + offset, sizeof(sizes));
+            const uint64_t keyBegin = offset + sizeof(sizes);
+            if(keyBegin + sizes[0] + sizes[1] > header.recordsEnd)
+                return std::nullopt;
+
+            const std::string_view storedKey(reinterpret_cast<const char*>(base + keyBegin), sizes[0]);
+            if(storedKey == key)
+                return std::string_view(reinterpret_cast<const char*>(base + keyBegin + sizes[0]), sizes[1]);
+        }
+
+        return std::nullopt;
+    }
+
+    bool mappedStore_c::insert(std::string_view key, std::string_view value)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex);
+
+        if(!canWrite)
+            return false;
+
+        auto &header = this->header();
+
+        // the table is kept at most three quarters full so that probing stays short
+        if((header.entryCount + 1) * 4 > header.bucketCount * 3)
+            return false;
+
+        const uint32_t sizes[2] = { static_cast<uint32_t>(key.size()), static_cast<uint32_t>(value.size()) };
+        const uint64_t recordSize = (sizeof(sizes) + key.size() + value.size() + STORE_RECORD_ALIGNMENT - 1) &
+            ~static_cast<uint64_t>(STORE_RECORD_ALIGNMENT - 1);
+        if(header.nextRecord + recordSize > header.recordsEnd)
+            return false;
+
+        const uint64_t hash = hashKey(key);
+        const uint64_t mask = header.bucketCount - 1;
+
+        bucket_t *bucket = nullptr;
+        for(uint64_t probe = 0; bucket == nullptr; probe++)
+        {
+            auto &candidate = buckets()[(hash + probe) & mask];
+            if(candidate.offset == 0)
+                bucket = &candidate;
+            else if(candidate.hash == hash && find(key))
+                return true;
+        }
+
+        const uint64_t offset = header.nextRecord;
+        std::memcpy(base + offset, sizes, sizeof(sizes));
+        std::memcpy(base + offset + sizeof(sizes), key.data(), key.size());
+        std::memcpy(base + offset + sizeof(sizes) + key.size(), value.data(), value.size());
+
+        // the header moves on before the bucket is published, so that a crash in between loses the record rather
+        // than leaving a published record that the next one overwrites
+        header.nextRecord += recordSize;
+        header.entryCount++;
+
+        bucket->hash = hash;
+        std::atomic_ref<uint64_t>(bucket->offset).store(offset, std::memory_order_release);
+        return true;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef SEQUENCER_STORE_H
+#define SEQUENCER_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace sequencer_n
+{
+    // open addressing hash table of byte strings in a memory mapped file: any number of processes look keys up
+    // without locking, while the one process that opened the file writable appends records behind the table and
+    // publishes each of them by a single atomic store into its bucket. The file does not grow, a full table or
+    // record region makes insert() return false
+    class mappedStore_c
+    {
+    public:
+        // opens the file at the given path, creating it with the given size in bytes if it is opened writable and
+        // does not exist yet, and starting it over if it holds no finished store of this version; returns nullptr if
+        // the file cannot be mapped or another process writes to it
+        static std::unique_ptr<mappedStore_c> open(const std::string &path, const bool writable, const size_t capacity);
+
+        mappedStore_c(const mappedStore_c&) = delete;
+        mappedStore_c &operator=(const mappedStore_c&) = delete;
+        ~mappedStore_c();
+
+        // the value stays valid as long as the store is open
+        std::optional<std::string_view> find(std::string_view key) const;
+        bool insert(std::string_view key, std::string_view value);
+
+        inline bool writable() const {
+            return canWrite;
+        }
+
+    private:
+        struct header_t;
+        struct bucket_t;
+
+        mappedStore_c() = default;
+
+        header_t &header() const;
+        bucket_t *buckets() const;
+
+#ifdef _WIN32
+        void *file = nullptr;
+        void *mapping = nullptr;
+#else
+        int descriptor = -1;
+#endif
+        uint8_t *base = nullptr;
+        size_t size = 0;
+        bool canWrite = false;
+
+        // threads of the writing process append one after another
+        std::mutex writeMutex;
+    };
+}
+
+#endif //SEQUENCER_STORE_H
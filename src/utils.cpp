@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <sstream>
 
 #include "sequencer/types.h"
@@ -5,27 +8,136 @@
 
 namespace sequencer_n
 {
-    bool approximatelyEqual(const sequence_t &a, const sequence_t &b, const double epsilon)
+    // the comparisons of a block are made without an early exit, so that the compiler can vectorize them
+    constexpr size_t REDUCTION_BLOCK_SIZE = 16;
+
+    inline double exactEpsilon(const double a) {
+        return std::pow(10, std::round(std::log10(std::abs(a))) - 5.0);
+    }
+
+    // the epsilon of the magnitudes of one binary exponent, which changes at most once within it
+    struct epsilonBucket_t
+    {
+        double lower;
+        double upper;
+        // magnitudes below lowerBound take the lower, above upperBound the upper epsilon; in between, which covers
+        // the boundary with a margin for the rounding of log10, the epsilon is calculated
+        double lowerBound;
+        double upperBound;
+    };
+
+    const std::array<epsilonBucket_t, 2048> &epsilonTable()
+    {
+        static const auto table = []() {
+            std::array<epsilonBucket_t, 2048> table {};
+
+            // the biased exponents of normal numbers, from which the bits of positive numbers ascend with their value
+            for(uint64_t exponent = 1; exponent < 0x7FF; exponent++)
+            {
+                uint64_t first = exponent << 52;
+                uint64_t last = first | 0xFFFFFFFFFFFFF;
+
+                auto &bucket = table[exponent];
+                bucket.lower = exactEpsilon(std::bit_cast<double>(first));
+                bucket.upper = exactEpsilon(std::bit_cast<double>(last));
+                bucket.lowerBound = bucket.upperBound = HUGE_VAL;
+
+                if(bucket.lower == bucket.upper)
+                    continue;
+
+                // the first magnitude that takes the upper epsilon
+                while(first + 1 < last)
+                {
+                    const uint64_t middle = first + (last - first) / 2;
+                    (exactEpsilon(std::bit_cast<double>(middle)) == bucket.upper ? last : first) = middle;
+                }
+
+                const double boundary = std::bit_cast<double>(last);
+                bucket.lowerBound = boundary * (1.0 - 1.0e-12);
+                bucket.upperBound = boundary * (1.0 + 1.0e-12);
+            }
+
+            return table;
+        }();
+
+        return table;
+    }
+
+    toleranceModel_c::toleranceModel_c(std::span<const double> sequence) :
+        referenceEpsilon(sequence.empty() ? 0.0 : epsilon(sequence.back())) {}
+
+    double toleranceModel_c::epsilon(const double a)
+    {
+        const double magnitude = std::abs(a);
+        const uint64_t exponent = std::bit_cast<uint64_t>(magnitude) >> 52;
+
+        // zero, subnormal and non-finite numbers
+        if(exponent == 0 || exponent == 0x7FF)
+            return exactEpsilon(a);
+
+        const auto &bucket = epsilonTable()[exponent];
+        if(magnitude < bucket.lowerBound)
+            return bucket.lower;
+        if(magnitude > bucket.upperBound)
+            return bucket.upper;
+
+        return exactEpsilon(a);
+    }
+
+    bool toleranceModel_c::allEqual(std::span<const double> a, std::span<const double> b, const double epsilon)
     {
         if(a.size() != b.size())
             return false;
-        
-        bool equal = true;
-        for(size_t i = 0; i < a.size() && equal; i++)
-            equal &= approximatelyEqual(a[i], b[i], epsilon);
-            
-        return equal;
+
+        for(size_t begin = 0; begin < a.size(); begin += REDUCTION_BLOCK_SIZE)
+        {
+            const size_t end = std::min(begin + REDUCTION_BLOCK_SIZE, a.size());
+
+            bool equal = true;
+            for(size_t i = begin; i < end; i++)
+                equal &= approximatelyEqual(a[i], b[i], epsilon);
+
+            if(!equal)
+                return false;
+        }
+
+        return true;
     }
 
-    bool approximatelyEqualLeastCommon(const sequence_t &standard, const sequence_t &suitor, const double epsilon)
+    bool toleranceModel_c::allIntegers(std::span<const double> terms)
+    {
+        for(size_t begin = 0; begin < terms.size(); begin += REDUCTION_BLOCK_SIZE)
+        {
+            const size_t end = std::min(begin + REDUCTION_BLOCK_SIZE, terms.size());
+
+            bool integral = true;
+            for(size_t i = begin; i < end; i++)
+                integral &= virtuallyInteger(terms[i]);
+
+            if(!integral)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool approximatelyEqual(std::span<const double> a, std::span<const double> b, const double epsilon) {
+        return toleranceModel_c::allEqual(a, b, epsilon);
+    }
+
+    bool approximatelyEqualLeastCommon(std::span<const double> standard, std::span<const double> suitor, const double epsilon)
     {
         if(standard.size() < suitor.size())
             return false;
-        
-        bool equal = true;
-        for(size_t i = 0; i < suitor.size() && equal; i++)
-            equal &= approximatelyEqual(standard[i], suitor[i], epsilon);
-            
-        return equal;
+
+        return toleranceModel_c::allEqual(standard.first(suitor.size()), suitor, epsilon);
+    }
+
+    bool approximatelyEqual(const sequence_t &a, const sequence_t &b, const double epsilon) {
+        return approximatelyEqual(std::span<const double>(a), std::span<const double>(b), epsilon);
+    }
+
+    bool approximatelyEqualLeastCommon(const sequence_t &standard, const sequence_t &suitor, const double epsilon) {
+        return approximatelyEqualLeastCommon(std::span<const double>(standard), std::span<const double>(suitor), epsilon);
     }
 }
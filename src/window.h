@@ -0,0 +1,77 @@
+#ifndef SEQUENCER_WINDOW_H
+#define SEQUENCER_WINDOW_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace sequencer_n
+{
+    constexpr size_t UNBOUNDED_LOOKBACK = static_cast<size_t>(-1);
+
+    // keeps the most recently generated terms in a ring buffer that is sized to the lookback of the rules
+    // as well as constant terms (given by rules like s(k) = c or referenced by a fixed index) in a side table
+    class termWindow_c
+    {
+    public:
+        void reset(const size_t capacity, const size_t firstIndex)
+        {
+            bounded = capacity != UNBOUNDED_LOOKBACK;
+
+            if(bounded)
+                ring.assign(std::max<size_t>(capacity, 1), DBL_MAX);
+            else
+                ring.clear();
+
+            this->firstIndex = firstIndex;
+            nextIndex = firstIndex;
+        }
+
+        inline void push(const double term)
+        {
+            if(bounded)
+                ring[nextIndex % ring.size()] = term;
+            else
+                ring.push_back(term);
+
+            if(pinnedIndices.count(nextIndex))
+                constants.insert({ nextIndex, term });
+
+            nextIndex++;
+        }
+
+        // looks up the term at the given index, which falls back to the constants once it left the window
+        inline double at(const int index) const
+        {
+            if(index >= 0 && static_cast<size_t>(index) >= firstIndex && static_cast<size_t>(index) < nextIndex)
+            {
+                if(!bounded)
+                    return ring[index - firstIndex];
+                if(nextIndex - static_cast<size_t>(index) <= ring.size())
+                    return ring[index % ring.size()];
+            }
+
+            auto find = constants.find(index);
+            return find != constants.end() ? find->second : DBL_MAX;
+        }
+
+        // looks up the term at the given index; bound to a window instance through the parser's user data
+        static double s(void *window, const double index) {
+            return static_cast<const termWindow_c*>(window)->at(static_cast<int>(round(index)));
+        }
+
+        std::map<size_t, double> constants;
+        std::set<size_t> pinnedIndices;
+
+    private:
+        std::vector<double> ring;
+        size_t firstIndex = 0;
+        size_t nextIndex = 0;
+        bool bounded = true;
+    };
+}
+
+#endif //SEQUENCER_WINDOW_H
@@ -1,6 +1,15 @@
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <memory_resource>
+#include <ranges>
 #include <string>
+#include <thread>
 #include <vector>
 #include <sequencer/sequencer.h>
+#include <sequencer/utils.h>
+#include "artefacts.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -64,6 +73,26 @@ namespace sequencer_n
             ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), expected));
         }
 
+        TEST(SequenceGenerator, ArithmeticSequenceExplicitLong)
+        {
+            sequence_t expected;
+            for(size_t n = 3; n < 10003; n++)
+                expected.push_back(3.0 * n + 2.0);
+
+            const auto actual = generate("3*n + 2", { 10000, 3 });
+            ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), expected));
+        }
+
+        TEST(SequenceGenerator, GeometricSequenceExplicitParallel)
+        {
+            generatorContext_t sequentialContext { 100000, 7 };
+            generatorContext_t parallelContext { 100000, 7, 4 };
+
+            const auto expected = generate("1.0001^n * cos(n)", sequentialContext);
+            const auto actual = generate("1.0001^n * cos(n)", parallelContext);
+            ASSERT_EQ(actual, expected);
+        }
+
         TEST(SequenceGenerator, FibonacciSequence)
         {
             const auto expected = sequence_t { 0, 1, 1, 2, 3, 5, 8, 13 };
@@ -71,6 +100,35 @@ namespace sequencer_n
             ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), expected));
         }
 
+        TEST(SequenceGenerator, FibonacciSequenceWithStartIndex)
+        {
+            const auto expected = sequence_t { 55, 89, 144, 233, 377 };
+            const auto actual = generate({ "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" }, { 5, 10 });
+            ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), expected));
+        }
+
+        TEST(SequenceGenerator, FibonacciTermJumpAhead)
+        {
+            const auto actual = generateTerm({ "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" }, 1400);
+            ASSERT_TRUE(actual.has_value());
+            ASSERT_NEAR(*actual / 1.7108476902340228e292, 1.0, 1.0e-9);
+        }
+
+        TEST(SequenceGenerator, CachedRuleSet)
+        {
+            clearRuleCache();
+            const auto expected = sequence_t { 0, 1, 1, 2, 3, 5, 8, 13 };
+            const auto first = generate({ "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" }, { 8 });
+            const auto second = generate({ " s(0) = 0", "s(1) = 1 ", "s(n) = s(n-1) + s(n-2)" }, { 8 });
+            ASSERT_THAT(first, Pointwise(DoubleNear(1.0e-5), expected));
+            ASSERT_THAT(second, Pointwise(DoubleNear(1.0e-5), expected));
+
+            const auto statistics = ruleCacheStatistics();
+            ASSERT_EQ(statistics.misses, 1);
+            ASSERT_EQ(statistics.hits, 1);
+            ASSERT_EQ(statistics.size, 1);
+        }
+
         TEST(SequenceGenerator, GenericRuleSequence)
         {
             const auto expected = sequence_t { 1, 6, 3, 8, 5, 10, 7, 12 };
@@ -78,6 +136,139 @@ namespace sequencer_n
             ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), expected));
         }
 
+        TEST(SequenceGenerator, LazyFibonacciSequence)
+        {
+            const auto expected = sequence_t { 0, 1, 1, 2, 3, 5, 8, 13, 21, 34, 55, 89 };
+            lazySequence_c sequence({ "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" });
+
+            sequence_t actual;
+            for(const double term : sequence | views::take_while([](double term) { return term < 100; }))
+                actual.push_back(term);
+
+            ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), expected));
+        }
+
+        TEST(SequenceGenerator, LazyExplicitSequenceWithStartIndex)
+        {
+            const auto expected = generate("2^n", { 10, 5 });
+            
+            sequence_t actual;
+            for(const double term : lazySequence_c({ "2^n" }, 5) | views::take(10))
+                actual.push_back(term);
+
+            ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), expected));
+        }
+
+        TEST(SequenceGenerator, BulkMatchesSingleTerms)
+        {
+            // muparser turns a lone variable or constant and a scaled or raised variable into single tokens of its
+            // bytecode, which its bulk mode evaluates by other code than longer bodies; the range crosses two chunks
+            for(const string rule : { "n", "7", "3*n", "3*n + 2", "n^2", "n^3 - n^4 / 5", "1.0001^n * cos(n) + mod(n, 7)" })
+            {
+                const auto actual = generate(rule, { 9000, 4000 });
+
+                sequence_t expected;
+                for(const double term : lazySequence_c({ rule }, 4000) | views::take(9000))
+                    expected.push_back(term);
+
+                ASSERT_EQ(actual.size(), expected.size());
+                for(size_t i = 0; i < expected.size(); i++)
+                    ASSERT_NEAR(actual[i], expected[i], 1.0e-12 * std::max(1.0, std::fabs(expected[i])));
+            }
+        }
+
+        TEST(SequenceGenerator, ConcurrentGeneration)
+        {
+            const vector<vector<string>> descriptions {
+                { "3*n + 2" },
+                { "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" },
+                { "s(0) = 1", "s(2*n + 1) = s(n-1) + 5", "s(2*n) = s(n-1) - 3" },
+                { "s(0) = 2", "s(n) = 2*s(n-1) - 1" }
+            };
+
+            vector<sequence_t> expected;
+            for(size_t i = 0; i < descriptions.size(); i++)
+                expected.push_back(generate(descriptions[i], { 64 + i }));
+
+            vector<size_t> mismatches(8, 0);
+            vector<thread> threads;
+
+            for(size_t t = 0; t < mismatches.size(); t++)
+            {
+                threads.emplace_back([&, t]() {
+                    for(size_t iteration = 0; iteration < 200; iteration++)
+                    {
+                        const size_t i = (t + iteration) % descriptions.size();
+                        if(generate(descriptions[i], { 64 + i }) != expected[i])
+                            mismatches[t]++;
+                    }
+                });
+            }
+
+            for(auto &thread : threads)
+                thread.join();
+
+            for(const auto count : mismatches)
+                ASSERT_EQ(count, 0);
+        }
+
+        TEST(SequenceGenerator, GenericRuleTermJumpAhead)
+        {
+            const vector<string> description { "s(0) = 1", "s(2*n + 1) = s(n-1) + 5", "s(2*n) = s(n-1) - 3" };
+            const auto expected = generate(description, { 3000 });
+            const auto actual = generate(description, { 4, 2996 });
+
+            ASSERT_EQ(generateTerm(description, 2999), expected.back());
+            ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), sequence_t(expected.end() - 4, expected.end())));
+        }
+
+        TEST(SequenceGenerator, ConditionalRuleNoJumpAhead)
+        {
+            // passes a probe for affinity on either branch, but must be stepped through term by term
+            const vector<string> description { "s(0) = 1", "s(n) = s(n-1) < 100 ? 2*s(n-1) : s(n-1) - 50" };
+            const auto expected = generate(description, { 2004 });
+            const auto actual = generate(description, { 4, 2000 });
+
+            ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), sequence_t { 116, 66, 132, 82 }));
+            ASSERT_THAT(actual, Pointwise(DoubleNear(1.0e-5), sequence_t(expected.end() - 4, expected.end())));
+            ASSERT_EQ(generateTerm(description, 2003), expected.back());
+        }
+
+        TEST(SequenceGenerator, CompiledBackend)
+        {
+            const vector<pair<vector<string>, generatorContext_t>> cases {
+                { { "3*n + 2" }, { 10000, 3 } },
+                { { "2^n" }, { 5, 5 } },
+                { { "5^n * (mod(n, 2) == 0 ? 1 : -1)" }, { 5 } },
+                { { "5^n * cos(_pi * n)" }, { 5 } },
+                { { "1.0001^n * cos(n)" }, { 100000, 7, 4 } },
+                { { "-2^2 + 2^3^2 - max(n, 3, sqrt(n)) / (1 + (n > 1 && n < 5 || n == 7))" }, { 10 } },
+                { { ".5*n + 1e-3 - 2.5E2" }, { 10 } },
+                { { "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" }, { 8 } },
+                { { "s(0) = 0", "s(1) = 1", "s(n) = s(n-1) + s(n-2)" }, { 5, 1000 } },
+                { { "s(0) = 1", "s(2*n + 1) = s(n-1) + 5", "s(2*n) = s(n-1) - 3" }, { 8 } },
+                { { "s(0) = 1", "s(1) = 3", "s(n) = s(n-1) * s(1) - s(0) + 1/s(n-2)" }, { 16 } }
+            };
+
+            for(const auto &[description, context] : cases)
+            {
+                generatorContext_t compiledContext = context;
+                compiledContext.expressionBackend = expressionBackend_t::COMPILED;
+
+                const auto expected = generate(description, context);
+                const auto actual = generate(description, compiledContext);
+                ASSERT_EQ(actual.size(), expected.size());
+                for(size_t i = 0; i < expected.size(); i++)
+                    ASSERT_NEAR(actual[i], expected[i], 1.0e-9 * std::max(1.0, std::fabs(expected[i])));
+            }
+
+            // muparser reads no hexadecimal numbers, and the compiled backend leaves them to it
+            generatorContext_t compiledContext { 5 };
+            compiledContext.expressionBackend = expressionBackend_t::COMPILED;
+            ASSERT_ANY_THROW(generate("0x10 + n", { 5 }));
+            ASSERT_ANY_THROW(generate("0x10 + n", compiledContext));
+        }
+
         TEST(SequenceSolver, EmptySequence)
         {
             const auto expected = sequence_t {};
@@ -125,6 +316,327 @@ namespace sequencer_n
             ASSERT_THAT(actual.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), expected));
         }
 
+        TEST(SequenceSolver, LinearRecursiveSequenceMinimalOrder)
+        {
+            const auto sequence = generate("sin(0.3*n) + 0.5*cos(0.7*n)", { 40 });
+            const auto expected = generate("sin(0.3*n) + 0.5*cos(0.7*n)", { 3, 40 });
+            const auto actual = solve(sequence, { 3 });
+            ASSERT_NE(actual.predictions.empty(), true);
+            ASSERT_EQ(actual.predictions[0].sequenceType, sequenceType_t::LINEAR_RECURSIVE);
+            ASSERT_EQ(describe(actual.predictions[0]).size(), 5);
+            ASSERT_THAT(actual.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), expected));
+        }
+
+        TEST(SequenceSolver, LinearRecursiveSequenceAboveMaximumOrder)
+        {
+            const auto actual = solve({ 0, 1, 3, 0, -7, -1, 20, 9, -53, -40 }, { 4, true, 2 });
+            for(const auto &prediction : actual.predictions)
+                ASSERT_NE(prediction.sequenceType, sequenceType_t::LINEAR_RECURSIVE);
+        }
+
+        TEST(SequenceSolver, LongContinuation)
+        {
+            const auto periodic = solve({ 1, 6, 3, 8, 5, 10, 7 }, { 10000 });
+            ASSERT_NE(periodic.predictions.empty(), true);
+            ASSERT_THAT(periodic.predictions[0].predictedContinuation,
+                Pointwise(DoubleNear(1.0e-5), generate({ "s(0) = 1", "s(2*n + 1) = s(n-1) + 5", "s(2*n) = s(n-1) - 3" }, { 10000, 7 })));
+
+            // above the orders that have a kernel of their own
+            const string rule = "sin(0.3*n) + 0.5*cos(0.7*n) + 0.25*sin(1.1*n)";
+            solverContext_t context { 1000 };
+            context.maximumRecurrenceOrder = 6;
+            const auto recurrence = solve(generate(rule, { 40 }), context);
+            ASSERT_NE(recurrence.predictions.empty(), true);
+            ASSERT_EQ(recurrence.predictions[0].sequenceType, sequenceType_t::LINEAR_RECURSIVE);
+            ASSERT_THAT(recurrence.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), generate(rule, { 1000, 40 })));
+        }
+
+        TEST(SequenceSolver, PolynomialSequence)
+        {
+            const auto triangular = solve({ 1, 3, 6, 10, 15 }, { 2 });
+            ASSERT_NE(triangular.predictions.empty(), true);
+            ASSERT_EQ(triangular.predictions[0].sequenceType, sequenceType_t::TRIANGULAR);
+            ASSERT_THAT(triangular.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), sequence_t { 21, 28 }));
+
+            const auto square = solve({ 1, 4, 9, 16, 25 }, { 2 });
+            ASSERT_NE(square.predictions.empty(), true);
+            ASSERT_EQ(square.predictions[0].sequenceType, sequenceType_t::SQUARE);
+            ASSERT_EQ(describe(square.predictions[0]), vector<string> { "s(n) = n^2 + 2n + 1" });
+            ASSERT_THAT(square.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), sequence_t { 36, 49 }));
+
+            const auto scaledSquare = solve(generate("3*(n - 2)^2", { 6 }), { 1 });
+            ASSERT_NE(scaledSquare.predictions.empty(), true);
+            ASSERT_EQ(scaledSquare.predictions[0].sequenceType, sequenceType_t::SQUARE);
+
+            // neither a multiple of a shifted triangular number nor of a shifted square
+            const auto quadratic = solve({ 1, 2, 5, 10, 17, 26 }, { 2 });
+            ASSERT_NE(quadratic.predictions.empty(), true);
+            ASSERT_EQ(quadratic.predictions[0].sequenceType, sequenceType_t::POLYNOMIAL);
+            ASSERT_EQ(describe(quadratic.predictions[0]), vector<string> { "s(n) = n^2 + 1" });
+            ASSERT_THAT(quadratic.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), sequence_t { 37, 50 }));
+
+            const auto cubic = solve(generate("n^3 - 2*n", { 8 }), { 2 });
+            ASSERT_NE(cubic.predictions.empty(), true);
+            ASSERT_EQ(cubic.predictions[0].sequenceType, sequenceType_t::CUBIC);
+            ASSERT_THAT(cubic.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), generate("n^3 - 2*n", { 2, 8 })));
+
+            const auto quartic = solve(generate("n^4", { 8 }), { 1 });
+            ASSERT_NE(quartic.predictions.empty(), true);
+            ASSERT_EQ(quartic.predictions[0].sequenceType, sequenceType_t::POLYNOMIAL);
+            ASSERT_THAT(quartic.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), sequence_t { 4096 }));
+        }
+
+        TEST(SequenceSolver, EnabledDetectorsOnly)
+        {
+            solverContext_t context { 2 };
+            context.enabledDetectors = detector_t::ARITHMETIC | detector_t::GEOMETRIC;
+
+            const auto arithmetic = solve({ 1, 3, 5 }, context);
+            ASSERT_NE(arithmetic.predictions.empty(), true);
+            ASSERT_EQ(arithmetic.predictions[0].sequenceType, sequenceType_t::ARITHMETIC);
+
+            const auto fibonacci = solve({ 0, 1, 1, 2, 3, 5, 8, 13 }, context);
+            ASSERT_EQ(fibonacci.predictions.empty(), true);
+        }
+
+        TEST(SequenceSolver, ParallelDetectors)
+        {
+            const vector<sequence_t> sequences {
+                { 1, 2, 4, 8 },
+                { 0, 1, 1, 2, 3, 5, 8, 13 },
+                { 1, 3, 5, 9, 11, 13, 15, 19 },
+                { 0, 1, 3, 0, -7, -1 }
+            };
+
+            for(const auto &sequence : sequences)
+            {
+                solverContext_t sequentialContext { 4, true };
+                solverContext_t parallelContext { 4, true };
+                parallelContext.parallelDetectors = true;
+
+                ASSERT_EQ(solve(sequence, parallelContext), solve(sequence, sequentialContext));
+            }
+        }
+
+        TEST(SequenceSolver, BatchMatchesSingleCalls)
+        {
+            vector<sequence_t> sequences;
+            for(size_t i = 0; i < 200; i++)
+            {
+                switch(i % 4)
+                {
+                    case 0: sequences.push_back({ 1.0 * i, 3.0 * i, 5.0 * i }); break;
+                    case 1: sequences.push_back({ 1, -5, 25, -125 }); break;
+                    case 2: sequences.push_back({ 0, 1, 1, 2, 3, 5, 8, 13 }); break;
+                    default: sequences.push_back({ 1, 3, 5, 9, 11, 13, 15, 19 }); break;
+                }
+            }
+
+            solverContext_t context { 3, true };
+            context.workerCount = 4;
+
+            const auto actual = solveBatch(sequences, context);
+            ASSERT_EQ(actual.size(), sequences.size());
+            for(size_t i = 0; i < sequences.size(); i++)
+                ASSERT_EQ(actual[i], solve(sequences[i], context));
+        }
+
+        TEST(SequenceSolver, ArenaAllocatedBatch)
+        {
+            const vector<sequence_t> sequences { { 1, 3, 5 }, { 1, -5, 25, -125 }, { 0, 1, 1, 2, 3, 5, 8, 13 }, { 42 } };
+
+            std::pmr::monotonic_buffer_resource arena;
+            solverContext_t context { 3, true };
+            context.workerCount = 1;
+            context.memoryResource = &arena;
+
+            const auto actual = solveBatch(sequences, context);
+            for(size_t i = 0; i < sequences.size(); i++)
+            {
+                const auto expected = solve(sequences[i], { 3, true });
+                ASSERT_EQ(actual[i], expected);
+                ASSERT_EQ(actual[i].predictions.get_allocator().resource(), &arena);
+
+                for(size_t j = 0; j < expected.predictions.size(); j++)
+                {
+                    ASSERT_EQ(actual[i].predictions[j].predictedContinuation.get_allocator().resource(), &arena);
+                    ASSERT_EQ(describe(actual[i].predictions[j]), describe(expected.predictions[j]));
+                    // the continuation copied into a sequence_t, as callers of the former member get it
+                    ASSERT_TRUE(approximatelyEqual(actual[i].predictions[j].continuation(), expected.predictions[j].continuation(), 0.0));
+                }
+            }
+        }
+
+        TEST(SequenceSolver, OnlineMatchesSolve)
+        {
+            const vector<sequence_t> sequences {
+                { 1, 3, 5, 7, 9, 11, 14, 17, 20 },
+                { 0, 1, 1, 2, 3, 5, 8, 13, 21, 34 },
+                { 1, 3, 5, 9, 11, 13, 15, 19, 21, 23 },
+                { 0, 1, 3, 0, -7, -1, 20, 9, -53, -40 },
+                // cubic until the last term
+                { 1, 8, 27, 64, 125, 216, 343, 512, 730 },
+                // the gap of 2 fails late, the gaps of 10 and 20 hold and the larger one is taken
+                { 1, 2, 4, 5, 7, 8, 10, 11, 13, 14, 17, 18, 20, 21, 23, 24, 26, 27, 29, 30, 33, 34 }
+            };
+
+            for(const auto &sequence : sequences)
+            {
+                for(const bool allowMultiplePredictions : { false, true })
+                {
+                    const solverContext_t context { 3, allowMultiplePredictions };
+                    onlineSolver_c solver(context);
+
+                    for(const double term : sequence)
+                    {
+                        solver.append(term);
+                        ASSERT_EQ(solver.solution(), solve(solver.sequence(), context));
+                    }
+                }
+            }
+        }
+
+        TEST(SequenceSolver, OnlineSolutionFromSeveralThreads)
+        {
+            const sequence_t sequence { 0, 1, 1, 2, 3, 5, 8, 13, 21, 34, 55, 89 };
+            const solverContext_t context { 3, true };
+
+            onlineSolver_c solver(context);
+            for(const double term : sequence)
+                solver.append(term);
+            const auto expected = solve(sequence, context);
+
+            vector<size_t> mismatches(8, 0);
+            vector<thread> threads;
+
+            for(size_t t = 0; t < mismatches.size(); t++)
+            {
+                threads.emplace_back([&, t]() {
+                    for(size_t iteration = 0; iteration < 200; iteration++)
+                        if(solver.solution() != expected)
+                            mismatches[t]++;
+                });
+            }
+
+            for(auto &thread : threads)
+                thread.join();
+
+            for(const auto count : mismatches)
+                ASSERT_EQ(count, 0);
+        }
+
+        TEST(SequenceSolver, WindowedMatchesSolve)
+        {
+            // an arithmetic, a Fibonacci like and a geometric stretch, so that the window passes from one to the next
+            const sequence_t sequence { 1, 3, 5, 7, 9, 11, 14, 17, 20, 37, 57, 94, 151, 245, 396, 3, 6, 12, 24, 48, 96, 192 };
+
+            for(const size_t windowSize : { 1, 2, 5, 8 })
+            {
+                for(const bool allowMultiplePredictions : { false, true })
+                {
+                    const solverContext_t context { 3, allowMultiplePredictions };
+                    windowedSolver_c solver(windowSize, context);
+
+                    for(const double term : sequence)
+                    {
+                        solver.push(term);
+                        const auto window = solver.window();
+                        ASSERT_LE(window.size(), windowSize);
+
+                        const auto expected = solve(sequence_t(window.begin(), window.end()), context);
+                        const auto actual = solver.solution();
+                        ASSERT_EQ(actual.predictions.size(), expected.predictions.size());
+
+                        // a recurrence that is carried over from earlier windows may differ in the last digits
+                        for(size_t i = 0; i < actual.predictions.size(); i++)
+                        {
+                            ASSERT_EQ(actual.predictions[i].sequenceType, expected.predictions[i].sequenceType);
+                            ASSERT_EQ(describe(actual.predictions[i]), describe(expected.predictions[i]));
+                            ASSERT_THAT(actual.predictions[i].predictedContinuation,
+                                Pointwise(DoubleNear(1.0e-6), expected.predictions[i].predictedContinuation));
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST(SequenceSolver, CachedSolution)
+        {
+            clearSolutionCache();
+            setSolutionCacheCapacity(16);
+
+            const sequence_t sequence { 1, 3, 5, 9, 11, 13, 15, 19 };
+            const auto first = solve(sequence, { 1 });
+            const auto extended = solve(sequence, { 4 });
+            const auto scaled = solve({ 3, 9, 15, 27, 33, 39, 45, 57 }, { 4 });
+            const auto statistics = solutionCacheStatistics();
+            setSolutionCacheCapacity(0);
+
+            // a scaled copy is solved again, since its detections may differ
+            ASSERT_EQ(statistics.misses, 2);
+            ASSERT_EQ(statistics.hits, 1);
+            ASSERT_EQ(first.predictions.size(), 1);
+            ASSERT_EQ(extended, solve(sequence, { 4 }));
+            ASSERT_EQ(scaled.predictions.size(), 1);
+            ASSERT_THAT(scaled.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), sequence_t { 63, 69, 75, 87 }));
+        }
+
+        TEST(SequenceSolver, StoredSolution)
+        {
+            const string path = (filesystem::temp_directory_path() / "sequencer_test_store.bin").string();
+            filesystem::remove(path);
+
+            const sequence_t sequence { 1, 3, 5, 9, 11, 13, 15, 19 };
+            const auto expected = solve(sequence, { 4 });
+
+            ASSERT_TRUE(openSolutionStore(path, true, 1 << 16));
+            ASSERT_EQ(solve(sequence, { 4 }), expected);
+            closeSolutionStore();
+
+            // a missing file is only created when it is opened writable
+            ASSERT_FALSE(openSolutionStore(path + ".missing", false));
+
+            ASSERT_TRUE(openSolutionStore(path, false));
+            const auto stored = solve(sequence, { 4 });
+            const auto scaled = solve({ 3, 9, 15, 27, 33, 39, 45, 57 }, { 4 });
+            closeSolutionStore();
+
+            // a file whose header was never finished is only created again when it is opened writable
+            filesystem::resize_file(path, 0);
+            filesystem::resize_file(path, 1 << 16);
+            ASSERT_FALSE(openSolutionStore(path, false));
+            ASSERT_TRUE(openSolutionStore(path, true));
+            ASSERT_EQ(solve(sequence, { 4 }), expected);
+            closeSolutionStore();
+            filesystem::remove(path);
+
+            ASSERT_EQ(stored, expected);
+            ASSERT_EQ(scaled.predictions.size(), 1);
+            ASSERT_THAT(scaled.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), sequence_t { 63, 69, 75, 87 }));
+        }
+
+        TEST(SequenceSolver, NoisyPeriodicSequence)
+        {
+            // the differences repeat every third term, but only up to rounding; the largest gap that holds is 9
+            sequence_t sequence;
+            for(size_t n = 0; n < 13; n++)
+                sequence.push_back(0.1 * n + n % 3 + 5);
+
+            const auto actual = solve(sequence, { 3 });
+            ASSERT_EQ(actual.predictions.size(), 1);
+            ASSERT_EQ(describe(actual.predictions[0]).size(), 9);
+            ASSERT_THAT(actual.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-9), sequence_t { 7.3, 8.4, 6.5 }));
+        }
+
+        TEST(SequenceSolver, LargestPeriodicGap)
+        {
+            // the gap of 3 holds for the given terms as well, but only the gap of 4 continues with the doubling
+            const auto expected = sequence_t { 16, 32, 34 };
+            const auto actual = solve({ 1, 3, 5, 10, 12, 14 }, { 3 });
+            ASSERT_NE(actual.predictions.empty(), true);
+            ASSERT_THAT(actual.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), expected));
+        }
+
         TEST(SequenceSolver, ConditionalSequence)
         {
             const auto expected = sequence_t { 21, 23, 25, 29 };
@@ -132,5 +644,81 @@ namespace sequencer_n
             ASSERT_NE(actual.predictions.empty(), true);
             ASSERT_THAT(actual.predictions[0].predictedContinuation, Pointwise(DoubleNear(1.0e-5), expected));
         }
+
+        TEST(SequenceUtils, ToleranceModel)
+        {
+            // around the powers of ten at which the epsilon changes, the table has to agree with log10 and pow
+            for(int exponent = -300; exponent <= 300; exponent += 7)
+            {
+                const double boundary = pow(10.0, exponent + 0.5);
+                for(const double a : { boundary, nextafter(boundary, 0.0), nextafter(boundary, HUGE_VAL), -boundary * 1.5 })
+                    ASSERT_EQ(calculateSuitableEpsilon(a), pow(10, round(log10(abs(a))) - 5.0));
+            }
+
+            ASSERT_EQ(calculateSuitableEpsilon(0.0), 0.0);
+
+            const toleranceModel_c tolerance(sequence_t { 1, 2, 1000 });
+            ASSERT_EQ(tolerance.sequenceEpsilon(), 0.01);
+            ASSERT_TRUE(tolerance.allEqual(sequence_t { 1000, 2000.01 }, sequence_t { 1000.001, 2000 }));
+            ASSERT_FALSE(tolerance.allEqual(sequence_t { 1000, 2000 }, sequence_t { 1000 }));
+            ASSERT_TRUE(toleranceModel_c::allIntegers(sequence_t { 1, 2.0000000001, -3 }));
+            ASSERT_FALSE(toleranceModel_c::allIntegers(sequence_t { 1, 2.5 }));
+        }
+
+        TEST(SequenceUtils, ArtefactKernels)
+        {
+            vector<sequence_t> sequences {
+                { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+                { 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 },
+                { -0.0, 0.0, -0.0, 0.0, 5, 0, 0, -5, 0, -0.0, 1 },
+                { 1, NAN, 2, 3, 4, 5, NAN, 6, 7, 8, 9 },
+                { 1, 2, INFINITY, 4, -INFINITY, 6, INFINITY, INFINITY, -INFINITY, -INFINITY, 1 },
+                { DBL_MAX, -DBL_MAX, DBL_MAX, DBL_MAX, 1, -DBL_MAX, -DBL_MAX, 0, DBL_MAX, 1e308, -1e308 },
+                { DBL_MIN, DBL_TRUE_MIN, -DBL_TRUE_MIN, 0, DBL_MIN, 2 * DBL_MIN, 3 * DBL_MIN, 1e-300, 1e-310, 1e-320, 0 }
+            };
+
+            /* differences that alternate between a base and a step about as far from it as the tolerance allows, around
+             * the powers of ten at which the epsilon changes and beyond the range that the bounds cover; the terms lie
+             * about as far from integers as virtuallyInteger() allows */
+            for(const double base : { 1.0, 3.1622776601683795, 0.31622776601683794, 31.622776601683793, 1.0e5, 1.0e-5,
+                1.0e139, 1.0e-139, 1.0e141, 1.0e-141, 1.0e160, 1.0e-160 })
+            {
+                for(int step = -20; step <= 20; step++)
+                {
+                    const double factor = 1.0 + step * 1.0e-13;
+                    const double next = base + base * calculateSuitableEpsilon(base) * factor;
+
+                    sequence_t alternating { 0 }, integers;
+                    for(size_t n = 1; n < 11; n++)
+                    {
+                        alternating.push_back(alternating.back() + (n % 2 ? base : next));
+                        const double integer = base * n + 2;
+                        integers.push_back(integer + integer * calculateSuitableEpsilon(integer) * factor);
+                    }
+
+                    sequences.push_back(alternating);
+                    sequences.push_back(integers);
+                }
+            }
+
+            // every prefix so that the kernels end at every lane
+            for(const auto &sequence : sequences)
+            {
+                for(size_t size = 2; size <= sequence.size(); size++)
+                {
+                    const span<const double> terms(sequence.data(), size);
+                    vector<double> differences(size - 1), ratios(size - 1), scalarDifferences(size - 1), scalarRatios(size - 1);
+
+                    const auto flags = extractArtefacts(terms, differences.data(), ratios.data());
+                    const auto scalarFlags = extractArtefactsScalar(terms, scalarDifferences.data(), scalarRatios.data());
+
+                    ASSERT_EQ(flags.constantDifference, scalarFlags.constantDifference);
+                    ASSERT_EQ(flags.constantRatio, scalarFlags.constantRatio);
+                    ASSERT_EQ(flags.containsDecimals, scalarFlags.containsDecimals);
+                    ASSERT_EQ(memcmp(differences.data(), scalarDifferences.data(), differences.size() * sizeof(double)), 0);
+                    ASSERT_EQ(memcmp(ratios.data(), scalarRatios.data(), ratios.size() * sizeof(double)), 0);
+                }
+            }
+        }
     }
 }